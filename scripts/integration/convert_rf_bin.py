@@ -0,0 +1,121 @@
+import struct
+import joblib
+import numpy as np
+
+# Converts the pruned sklearn forests into the binary DT forest file read by the encoder (option DTForestFile).
+# path_rf_model is the folder containing hv_W_H.pkl, qm_W_H.pkl, bt_W_H.pkl and the inter tool models, tree indices are
+# the ones printed by get_tree_num.py. BT/TT models are trained on the BT/TT records of the encoder dataset (decision 2), one per block size.
+
+path_rf_model = ""
+output_file = "dt_forest.bin"
+
+DT_FOREST_MAGIC = 0x46544456
+DT_FOREST_VERSION = 2
+
+DT_DECISION_QT_MTT = 0
+DT_DECISION_HOR_VER = 1
+DT_DECISION_BT_TT = 2
+DT_DECISION_AFFINE = 6
+DT_DECISION_GEO = 7
+DT_DECISION_CIIP = 8
+DT_DECISION_MMVD = 9
+
+num_features = {DT_DECISION_QT_MTT: 34, DT_DECISION_HOR_VER: 45, DT_DECISION_BT_TT: 22,
+                DT_DECISION_AFFINE: 45, DT_DECISION_GEO: 45, DT_DECISION_CIIP: 45, DT_DECISION_MMVD: 45}
+
+indices_qm = {
+    (128, 128): [6, 10, 24, 18, 8, 27, 2, 21, 34, 0, 35, 14, 25, 32, 4, 1, 3, 37, 11, 20, 29, 13],
+    (64, 64): [19, 11, 39, 33, 13, 32, 5, 34, 36, 9, 24, 12, 4, 10, 37],
+    (32, 32): [10, 34, 8, 39, 14, 13, 27, 12, 7, 2, 37],
+    (16, 16): [27, 23, 33, 2, 11, 1, 21, 32, 4, 7],
+}
+
+indices_hv = {
+    (8, 8): [28, 24, 33, 3, 39, 0, 21, 10, 38, 5, 25, 1, 19, 4, 13, 36, 27, 14, 12, 11, 20, 17, 15, 35],
+    (8, 16): [30, 13, 8, 5, 3, 31, 14, 36, 17, 20, 10, 25, 39, 32],
+    (8, 32): [33, 32, 6, 22, 7, 12, 20, 39, 9, 16, 31, 29, 34, 3, 2, 5],
+    (8, 64): [22, 12, 3, 32, 34, 13, 2, 15, 18, 37],
+    (16, 8): [12, 37, 19, 33, 6, 25, 36, 11, 28, 23, 0, 34, 9, 20, 5, 18, 29, 26, 4, 17, 10, 8, 39],
+    (16, 16): [35, 30, 3, 9, 16, 2, 13, 33, 14, 18, 38, 29, 4, 6, 8, 36, 0, 7, 32, 24],
+    (16, 32): [22, 2, 27, 12, 29, 5, 37, 11, 10, 21],
+    (16, 64): [22, 6, 4, 16, 0, 1, 10, 19, 32, 25, 18, 9, 27, 17, 28, 34, 13, 37, 39, 35],
+    (32, 8): [19, 20, 12, 17, 10, 16, 0, 25, 15, 22],
+    (32, 16): [11, 21, 39, 24, 35, 0, 13, 14, 28, 22, 25, 34, 2, 10, 1, 12],
+    (32, 32): [20, 13, 21, 29, 19, 34, 8, 9, 22, 32, 30, 16, 1, 35, 14],
+    (32, 64): [7, 24, 26, 15, 30, 9, 13, 22, 3, 0, 17, 18, 29, 11, 10, 16],
+    (64, 8): [37, 1, 12, 38, 16, 11, 34, 20, 13, 0, 32],
+    (64, 16): [27, 38, 25, 5, 16, 0, 21, 36, 22, 2, 3, 12],
+    (64, 32): [28, 30, 14, 11, 13, 29, 5, 20, 10, 4, 24, 34, 19],
+    (64, 64): [8, 23, 1, 20, 3, 10, 13, 31, 28, 5, 2, 18],
+    (128, 128): [38, 39, 30, 19, 20, 28, 22, 5, 18, 25, 31, 17, 8, 9, 24, 23, 2, 0, 7, 21, 6],
+}
+
+# (W, H): tree indices, sizes without an entry are not pruned by the BT/TT decision
+indices_bt = {}
+
+# inter tool decisions, trained on the tool records (decisions 6 to 9) labelled with the toolFlags of the best non-split
+# cost record: prefix of the .pkl files -> (decision, {(W, H): tree indices})
+indices_tools = {
+    "affine": (DT_DECISION_AFFINE, {}),
+    "geo": (DT_DECISION_GEO, {}),
+    "ciip": (DT_DECISION_CIIP, {}),
+    "mmvd": (DT_DECISION_MMVD, {}),
+}
+
+
+def flatten(model, indices):
+    # nodes are written in pre-order: the left child follows its parent, the right child is found by offset
+    roots, feature, threshold, right_offset = [], [], [], []
+    for i in indices:
+        tree = model.estimators_[i].tree_
+        roots.append(len(feature))
+        stack = [(0, None)]
+        while stack:
+            n, parent = stack.pop()
+            pos = len(feature)
+            if parent is not None:
+                right_offset[parent] = pos - parent
+            if tree.children_left[n] == -1:
+                counts = tree.value[n][0]
+                feature.append(-1)
+                threshold.append(float(counts[1] / counts.sum()))
+                right_offset.append(0)
+            else:
+                feature.append(int(tree.feature[n]))
+                threshold.append(float(tree.threshold[n]))
+                right_offset.append(0)
+                stack.append((int(tree.children_right[n]), pos))
+                stack.append((int(tree.children_left[n]), None))
+    return roots, feature, threshold, right_offset
+
+
+models = []
+for (w, h), ind in indices_qm.items():
+    models.append((DT_DECISION_QT_MTT, w, h, flatten(joblib.load(path_rf_model + "/qm_%d_%d.pkl" % (w, h)), ind)))
+for (w, h), ind in indices_hv.items():
+    models.append((DT_DECISION_HOR_VER, w, h, flatten(joblib.load(path_rf_model + "/hv_%d_%d.pkl" % (w, h)), ind)))
+for (w, h), ind in indices_bt.items():
+    models.append((DT_DECISION_BT_TT, w, h, flatten(joblib.load(path_rf_model + "/bt_%d_%d.pkl" % (w, h)), ind)))
+for prefix, (decision, indices) in indices_tools.items():
+    for (w, h), ind in indices.items():
+        models.append((decision, w, h, flatten(joblib.load(path_rf_model + "/%s_%d_%d.pkl" % (prefix, w, h)), ind)))
+
+header_size = 16
+entry_size = 6 * 4 + 4 * 8
+offset = header_size + len(models) * entry_size
+
+entries = b""
+payload = b""
+for decision, w, h, (roots, feature, threshold, right_offset) in models:
+    offsets = []
+    for arr, dtype in ((roots, "<u4"), (feature, "<i4"), (threshold, "<f4"), (right_offset, "<u4")):
+        offsets.append(offset + len(payload))
+        payload += np.asarray(arr, dtype=dtype).tobytes()
+    entries += struct.pack("<6I4Q", decision, w, h, num_features[decision], len(roots), len(feature), *offsets)
+
+with open(output_file, "wb") as f:
+    f.write(struct.pack("<4I", DT_FOREST_MAGIC, DT_FOREST_VERSION, len(models), 0))
+    f.write(entries)
+    f.write(payload)
+
+print("Wrote {} models to {}".format(len(models), output_file))
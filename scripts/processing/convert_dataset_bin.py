@@ -0,0 +1,64 @@
+import os
+import numpy as np
+
+# Converts the binary dataset files written by the encoder (split_features_*.bin and split_cost_*.bin) into the
+# semicolon-separated csv files read by sep_frames.py. The records can also be used directly: np.fromfile with the
+# dtypes below gives one column per field.
+
+#Path to the folder containing the .bin files
+
+path_dataset = ""
+
+DT_DATASET_FEATURE_MAGIC = 0x46534456
+DT_DATASET_COST_MAGIC = 0x43534456
+DT_DATASET_VERSION = 1
+
+header_dtype = np.dtype([("magic", "<u4"), ("version", "<u4"), ("recordSize", "<u4"), ("maxFeatures", "<u4")])
+
+
+def feature_dtype(max_features):
+    return np.dtype([("poc", "<i4"), ("width", "<u2"), ("height", "<u2"), ("x", "<i4"), ("y", "<i4"),
+                     ("splitSeries", "<u8"), ("decision", "<u4"), ("numFeatures", "<u4"),
+                     ("features", "<f4", (max_features,)), ("reserved", "<u4")])
+
+
+cost_dtype = np.dtype([("poc", "<i4"), ("width", "<u2"), ("height", "<u2"), ("x", "<i4"), ("y", "<i4"),
+                       ("splitSeries", "<u8"), ("splitType", "<u4"), ("toolFlags", "<u4"), ("cost", "<f8")])
+
+
+def read_dataset(file_name):
+    header = np.fromfile(file_name, dtype=header_dtype, count=1)[0]
+    assert header["version"] == DT_DATASET_VERSION, file_name
+
+    if header["magic"] == DT_DATASET_FEATURE_MAGIC:
+        dtype = feature_dtype(header["maxFeatures"])
+    else:
+        assert header["magic"] == DT_DATASET_COST_MAGIC, file_name
+        dtype = cost_dtype
+
+    assert dtype.itemsize == header["recordSize"], file_name
+    return np.fromfile(file_name, dtype=dtype, offset=header_dtype.itemsize)
+
+
+def write_features_csv(records, file_name):
+    with open(file_name, "w") as f:
+        for r in records:
+            f.write("%d;%d;%d;%d;%d;%d;%d;" % (r["poc"], r["height"], r["width"], r["x"], r["y"], r["splitSeries"], r["decision"]))
+            f.write("".join("%f;" % v for v in r["features"][:r["numFeatures"]]))
+            f.write("\n")
+
+
+def write_cost_csv(records, file_name):
+    with open(file_name, "w") as f:
+        for r in records:
+            f.write("%d;%d;%d;%d;%d;%d;%d;%.1f;%d;\n" % (r["poc"], r["height"], r["width"], r["x"], r["y"], r["splitSeries"], r["splitType"], r["cost"], r["toolFlags"]))
+
+
+for f in sorted(os.listdir(path_dataset)):
+    if f.endswith(".bin") and (f.startswith("split_features") or f.startswith("split_cost")):
+        records = read_dataset(os.path.join(path_dataset, f))
+        csv_name = os.path.join(path_dataset, f[:-len(".bin")] + ".csv")
+        if f.startswith("split_features"):
+            write_features_csv(records, csv_name)
+        else:
+            write_cost_csv(records, csv_name)
@@ -0,0 +1,697 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTTrainApp.cpp
+    \brief    DT forest training application class
+*/
+
+#include "DTTrainApp.h"
+
+#include "EncoderLib/DTDataset.h"
+#include "EncoderLib/EncModeCtrl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+//! \ingroup DTTrainApp
+//! \{
+
+// costs of a block that label its decisions, 0 if the split or the non-split modes were not tested
+enum DTCostIdx
+{
+  COST_QT = 0,
+  COST_BT_H,
+  COST_BT_V,
+  COST_TT_H,
+  COST_TT_V,
+  COST_NO_SPLIT,
+  NUM_DT_COSTS
+};
+
+struct DTBlockCosts
+{
+  double   cost[NUM_DT_COSTS];
+  uint32_t toolFlags;   ///< DTToolFlags of the best non-split mode
+};
+
+static int costIdx( const uint32_t splitType )
+{
+  switch( splitType )
+  {
+  case ETM_SPLIT_QT:        return COST_QT;
+  case ETM_SPLIT_BT_H:      return COST_BT_H;
+  case ETM_SPLIT_BT_V:      return COST_BT_V;
+  case ETM_SPLIT_TT_H:      return COST_TT_H;
+  case ETM_SPLIT_TT_V:      return COST_TT_V;
+  case ETM_POST_DONT_SPLIT: return COST_NO_SPLIT;
+  default:                  return -1;
+  }
+}
+
+/// the smaller of two costs, ignoring the untested ones
+static double minCost( const double a, const double b )
+{
+  return a > 0.0 && b > 0.0 ? std::min( a, b ) : std::max( a, b );
+}
+
+template<typename T>
+static void readRecords( const std::string& fileName, const uint32_t magic, std::vector<T>& records )
+{
+  FILE* file = fopen( fileName.c_str(), "rb" );
+  CHECK( !file, "Cannot open DT dataset file " << fileName );
+
+  DTDatasetFileHeader header;
+  const bool validHeader = fread( &header, sizeof( header ), 1, file ) == 1;
+  if( !validHeader || header.magic != magic || header.version != DT_DATASET_VERSION || header.recordSize != sizeof( T ) )
+  {
+    fclose( file );
+    THROW( "DT dataset file " << fileName << " has an unknown format" );
+  }
+
+  fseek( file, 0, SEEK_END );
+  const long size = ftell( file ) - long( sizeof( header ) );
+  fseek( file, sizeof( header ), SEEK_SET );
+
+  records.resize( size / sizeof( T ) );
+  const size_t numRead = records.empty() ? 0 : fread( &records[0], sizeof( T ), records.size(), file );
+  fclose( file );
+  CHECK( numRead != records.size(), "DT dataset file " << fileName << " is truncated" );
+}
+
+// ====================================================================================================================
+// Constructor / destructor / initialization / destroy
+// ====================================================================================================================
+
+DTTrainApp::DTTrainApp()
+{
+}
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+int DTTrainApp::train()
+{
+  m_rng.seed( m_seed );
+
+  std::map<ModelKey, DTTrainSet> sets;
+  xReadDatasets( sets );
+
+  std::vector<std::tuple<ModelKey, std::vector<DTTrainTree>>> models;
+
+  const char* decisionName[NUM_DT_DECISIONS] = { "QT/MTT", "Hor/Ver", "BT/TT", "I split", "I QT/MTT", "I Hor/Ver", "Affine", "GEO", "CIIP", "MMVD" };
+
+  msg( INFO, "\nModel              samples   trained  accuracy (all trees)  accuracy (kept trees)  trees\n" );
+  for( auto& it : sets )
+  {
+    const ModelKey& key         = it.first;
+    DTTrainSet&     set         = it.second;
+    const int       decision    = std::get<0>( key );
+    const int       width       = std::get<1>( key );
+    const int       height      = std::get<2>( key );
+    const int       numFeatures = std::get<3>( key );
+    const char*     name        = decisionName[decision];
+
+    // the sample count is checked after balancing, a block size that (nearly) always takes one choice gets no model
+    DTTrainSet trainSet, testSet;
+    xSplitSet( set, numFeatures, trainSet, testSet );
+    const int numLabelled = int( set.size() );
+    set = DTTrainSet();
+
+    if( int( trainSet.size() + testSet.size() ) < m_minSamples || trainSet.size() == 0 )
+    {
+      msg( INFO, "  %-9s %3dx%-3d  %9d   skipped\n", name, width, height, numLabelled );
+      continue;
+    }
+
+    BinnedSet binned;
+    xBinSet( trainSet, numFeatures, binned );
+
+    // the trees are independent, each one is grown from its own seed so the result does not depend on the threads
+    std::vector<DTTrainTree> trees( m_numTrees );
+    std::atomic<int>         nextTree( 0 );
+    std::vector<std::thread> workers;
+    for( int t = 0; t < std::min( m_numThreads, m_numTrees ); t++ )
+    {
+      workers.emplace_back( [&]()
+      {
+        for( int i = nextTree++; i < m_numTrees; i = nextTree++ )
+        {
+          xGrowTree( trainSet, binned, m_seed * 7919 + i, trees[i] );
+        }
+      } );
+    }
+    for( auto& worker : workers )
+    {
+      worker.join();
+    }
+
+    std::vector<int> selected;
+    double           fullAccuracy = 0.0, accuracy = 0.0;
+    xSelectTrees( trees, testSet, numFeatures, selected, fullAccuracy, accuracy );
+
+    std::vector<DTTrainTree> kept;
+    for( int i : selected )
+    {
+      kept.push_back( std::move( trees[i] ) );
+    }
+    models.emplace_back( key, std::move( kept ) );
+
+    msg( INFO, "  %-9s %3dx%-3d  %9d %9d  %20.4f  %21.4f  %5d\n", name, width, height, (int) ( trainSet.size() + testSet.size() ),
+         (int) trainSet.size(), fullAccuracy, accuracy, (int) selected.size() );
+  }
+
+  xWriteForest( models );
+  return int( models.size() );
+}
+
+// ====================================================================================================================
+// Private member functions
+// ====================================================================================================================
+
+/** Joins the feature records with the costs of the same block and labels them the way the training scripts do, class 1
+ *  being MTT for QT/MTT, vertical for Hor/Ver, TT for BT/TT, split for the intra split decision, and the use of the tool
+ *  by the best non-split mode for the inter tool decisions. Like the scripts, QT/MTT and Hor/Ver samples need two tested
+ *  MTT splits. Ties and non-finite features are left out, and every sample is weighted by the cost difference of both
+ *  choices; the tool decisions have no cost without the tool and get a weight of 1.
+ */
+void DTTrainApp::xReadDatasets( std::map<ModelKey, DTTrainSet>& sets )
+{
+  std::map<BlockKey, DTBlockCosts> costs;
+  size_t                           numFeatureRecords = 0;
+
+  for( int d = 0; d < (int) m_datasetNames.size(); d++ )
+  {
+    std::vector<DTCostRecord> costRecords;
+    readRecords( m_datasetPath + "split_cost_" + m_datasetNames[d] + ".bin", DT_DATASET_COST_MAGIC, costRecords );
+
+    for( const DTCostRecord& r : costRecords )
+    {
+      const int idx = costIdx( r.splitType );
+      if( idx < 0 )
+      {
+        continue;
+      }
+      auto it = costs.emplace( BlockKey( d, r.poc, r.x, r.y, r.width, r.height, r.splitSeries ), DTBlockCosts() );
+      DTBlockCosts& block = it.first->second;
+      if( it.second )
+      {
+        std::fill_n( block.cost, int( NUM_DT_COSTS ), 0.0 );
+        block.toolFlags = 0;
+      }
+      if( block.cost[idx] == 0.0 || r.cost < block.cost[idx] )
+      {
+        block.cost[idx] = r.cost;
+        block.toolFlags = idx == COST_NO_SPLIT ? r.toolFlags : block.toolFlags;
+      }
+    }
+  }
+
+  for( int d = 0; d < (int) m_datasetNames.size(); d++ )
+  {
+    std::vector<DTFeatureRecord> featureRecords;
+    readRecords( m_datasetPath + "split_features_" + m_datasetNames[d] + ".bin", DT_DATASET_FEATURE_MAGIC, featureRecords );
+    numFeatureRecords += featureRecords.size();
+
+    for( const DTFeatureRecord& r : featureRecords )
+    {
+      auto block = costs.find( BlockKey( d, r.poc, r.x, r.y, r.width, r.height, r.splitSeries ) );
+      if( block == costs.end() || r.decision >= NUM_DT_DECISIONS || r.numFeatures > DT_DATASET_MAX_FEATURES )
+      {
+        continue;
+      }
+
+      const double* c         = block->second.cost;
+      const int     numMtt    = int( std::count_if( c + COST_BT_H, c + COST_TT_V + 1, []( double v ) { return v > 0.0; } ) );
+      const double  minHor    = minCost( c[COST_BT_H], c[COST_TT_H] );
+      const double  minVer    = minCost( c[COST_BT_V], c[COST_TT_V] );
+      const double  minSplit  = minCost( c[COST_QT], minCost( minHor, minVer ) );
+      double        cost0 = 0.0, cost1 = 0.0;
+      switch( r.decision )
+      {
+      case DT_DECISION_QT_MTT:
+      case DT_DECISION_INTRA_QT_MTT:
+        cost0 = numMtt > 1 ? c[COST_QT] : 0.0;
+        cost1 = minCost( minHor, minVer );
+        break;
+      case DT_DECISION_HOR_VER:
+      case DT_DECISION_INTRA_HOR_VER:
+        cost0 = numMtt > 1 ? minHor : 0.0;
+        cost1 = minVer;
+        break;
+      case DT_DECISION_BT_TT:
+        cost0 = r.features[2] != 0.0f ? c[COST_BT_H] : c[COST_BT_V];
+        cost1 = r.features[2] != 0.0f ? c[COST_TT_H] : c[COST_TT_V];
+        break;
+      case DT_DECISION_INTRA_SPLIT:
+        cost0 = c[COST_NO_SPLIT];
+        cost1 = minSplit;
+        break;
+      default:
+      {
+        // inter tools, in the order of DTToolFlags; costs 1 and 2 give the label with a unit weight
+        const bool used = ( block->second.toolFlags & ( 1u << ( r.decision - DT_DECISION_AFFINE ) ) ) != 0;
+        cost0 = c[COST_NO_SPLIT] > 0.0 ? ( used ? 2.0 : 1.0 ) : 0.0;
+        cost1 = c[COST_NO_SPLIT] > 0.0 ? ( used ? 1.0 : 2.0 ) : 0.0;
+        break;
+      }
+      }
+      if( cost0 == 0.0 || cost1 == 0.0 || cost0 == cost1 )
+      {
+        continue;
+      }
+      if( !std::all_of( r.features, r.features + r.numFeatures, []( float v ) { return std::isfinite( v ); } ) )
+      {
+        continue;
+      }
+
+      DTTrainSet& set = sets[ModelKey( r.decision, r.width, r.height, r.numFeatures )];
+      set.features.insert( set.features.end(), r.features, r.features + r.numFeatures );
+      set.labels  .push_back( cost1 < cost0 ? 1 : 0 );
+      set.weights .push_back( float( std::abs( cost1 - cost0 ) ) );
+    }
+  }
+
+  msg( INFO, "Read %d feature records of %d datasets, %d blocks with costs\n", (int) numFeatureRecords, (int) m_datasetNames.size(), (int) costs.size() );
+}
+
+/// shuffles the samples, balances the classes and holds out the test samples
+void DTTrainApp::xSplitSet( const DTTrainSet& set, const int numFeatures, DTTrainSet& trainSet, DTTrainSet& testSet )
+{
+  std::vector<size_t> order[2];
+  for( size_t i = 0; i < set.size(); i++ )
+  {
+    order[set.labels[i]].push_back( i );
+  }
+  for( int c = 0; c < 2; c++ )
+  {
+    std::shuffle( order[c].begin(), order[c].end(), m_rng );
+  }
+  if( m_balanceClasses )
+  {
+    const size_t numPerClass = std::min( order[0].size(), order[1].size() );
+    order[0].resize( numPerClass );
+    order[1].resize( numPerClass );
+  }
+
+  std::vector<size_t> samples( order[0] );
+  samples.insert( samples.end(), order[1].begin(), order[1].end() );
+  std::shuffle( samples.begin(), samples.end(), m_rng );
+  if( m_maxSamples > 0 && (int) samples.size() > m_maxSamples )
+  {
+    samples.resize( m_maxSamples );
+  }
+
+  const size_t numTest = size_t( samples.size() * m_testFraction );
+  for( size_t s = 0; s < samples.size(); s++ )
+  {
+    DTTrainSet&  dst = s < numTest ? testSet : trainSet;
+    const size_t i   = samples[s];
+    dst.features.insert( dst.features.end(), set.features.begin() + i * numFeatures, set.features.begin() + ( i + 1 ) * numFeatures );
+    dst.labels  .push_back( set.labels [i] );
+    dst.weights .push_back( set.weights[i] );
+  }
+}
+
+/** Quantizes every feature into at most NumBins bins, whose edges are quantiles of the training samples. Splits are
+ *  searched on the bin histograms and placed on bin edges, which are feature values, so the trees compare the raw
+ *  features the same way the encoder does.
+ */
+void DTTrainApp::xBinSet( const DTTrainSet& set, const int numFeatures, BinnedSet& binned ) const
+{
+  const size_t n = set.size();
+
+  binned.numFeatures = numFeatures;
+  binned.edges.assign( numFeatures, std::vector<float>() );
+  binned.bins .resize( n * numFeatures );
+
+  std::vector<float> values( n );
+  for( int f = 0; f < numFeatures; f++ )
+  {
+    for( size_t i = 0; i < n; i++ )
+    {
+      values[i] = set.features[i * numFeatures + f];
+    }
+    std::sort( values.begin(), values.end() );
+    values.erase( std::unique( values.begin(), values.end() ), values.end() );
+
+    std::vector<float>& edges = binned.edges[f];
+    if( (int) values.size() <= m_numBins )
+    {
+      edges = values;
+    }
+    else
+    {
+      for( int b = 0; b < m_numBins; b++ )
+      {
+        edges.push_back( values[( b + 1 ) * values.size() / m_numBins - 1] );
+      }
+      edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+    }
+
+    for( size_t i = 0; i < n; i++ )
+    {
+      const float v = set.features[i * numFeatures + f];
+      binned.bins[i * numFeatures + f] = uint8_t( std::lower_bound( edges.begin(), edges.end(), v ) - edges.begin() );
+    }
+    values.resize( n );
+  }
+}
+
+/// grows one tree on a bootstrap sample of the training set, as the forests of the training scripts do
+void DTTrainApp::xGrowTree( const DTTrainSet& set, const BinnedSet& binned, const int seed, DTTrainTree& tree ) const
+{
+  std::mt19937                          rng( seed );
+  std::uniform_int_distribution<size_t> draw( 0, set.size() - 1 );
+
+  std::vector<float> weights( set.size(), 0.0f );
+  for( size_t i = 0; i < set.size(); i++ )
+  {
+    weights[draw( rng )] += 1.0f;
+  }
+
+  std::vector<uint32_t> samples;
+  for( size_t i = 0; i < set.size(); i++ )
+  {
+    if( weights[i] > 0.0f )
+    {
+      weights[i] *= set.weights[i];
+      samples.push_back( uint32_t( i ) );
+    }
+  }
+
+  tree.clear();
+  xGrowNode( set, binned, weights, samples, 0, samples.size(), 0, rng, tree );
+}
+
+/** Grows the node of the samples [begin, end). The split maximizes the decrease of the weighted Gini impurity over
+ *  sqrt(numFeatures) randomly drawn features, more are drawn while none of them can split the node.
+ */
+int DTTrainApp::xGrowNode( const DTTrainSet& set, const BinnedSet& binned, std::vector<float>& weights, std::vector<uint32_t>& samples,
+                           const size_t begin, const size_t end, const int depth, std::mt19937& rng, DTTrainTree& tree ) const
+{
+  const int numFeatures = binned.numFeatures;
+
+  double w[2] = { 0.0, 0.0 };
+  for( size_t s = begin; s < end; s++ )
+  {
+    w[set.labels[samples[s]]] += weights[samples[s]];
+  }
+
+  const int node = int( tree.size() );
+  tree.push_back( { -1, float( w[1] / ( w[0] + w[1] ) ), -1, -1 } );
+
+  if( depth >= m_maxDepth || int( end - begin ) < m_minSamplesSplit || w[0] == 0.0 || w[1] == 0.0 )
+  {
+    return node;
+  }
+
+  std::vector<int> featureOrder( numFeatures );
+  for( int f = 0; f < numFeatures; f++ )
+  {
+    featureOrder[f] = f;
+  }
+  std::shuffle( featureOrder.begin(), featureOrder.end(), rng );
+
+  const int maxFeatures = std::max( 1, int( std::sqrt( double( numFeatures ) ) ) );
+  double    bestScore   = ( w[0] * w[0] + w[1] * w[1] ) / ( w[0] + w[1] ) * ( 1.0 + 1e-9 );
+  int       bestFeature = -1, bestBin = -1;
+
+  std::vector<double> hist[2];
+  std::vector<int>    count;
+  for( int k = 0; k < numFeatures && ( k < maxFeatures || bestFeature < 0 ); k++ )
+  {
+    const int f       = featureOrder[k];
+    const int numBins = int( binned.edges[f].size() );
+    hist[0].assign( numBins, 0.0 );
+    hist[1].assign( numBins, 0.0 );
+    count  .assign( numBins, 0 );
+    for( size_t s = begin; s < end; s++ )
+    {
+      const uint32_t i = samples[s];
+      const int      b = binned.bins[i * numFeatures + f];
+      hist[set.labels[i]][b] += weights[i];
+      count[b]++;
+    }
+
+    double wl[2] = { 0.0, 0.0 };
+    int    nl    = 0;
+    for( int b = 0; b < numBins - 1; b++ )
+    {
+      wl[0] += hist[0][b];
+      wl[1] += hist[1][b];
+      nl    += count[b];
+      if( nl == 0 )
+      {
+        continue;
+      }
+      if( nl == int( end - begin ) )
+      {
+        break;
+      }
+      const double wr[2] = { w[0] - wl[0], w[1] - wl[1] };
+      const double sl    = wl[0] + wl[1], sr = wr[0] + wr[1];
+      if( sl <= 0.0 || sr <= 0.0 )
+      {
+        continue;
+      }
+      const double score = ( wl[0] * wl[0] + wl[1] * wl[1] ) / sl + ( wr[0] * wr[0] + wr[1] * wr[1] ) / sr;
+      if( score > bestScore )
+      {
+        bestScore   = score;
+        bestFeature = f;
+        bestBin     = b;
+      }
+    }
+  }
+
+  if( bestFeature < 0 )
+  {
+    return node;
+  }
+
+  const auto mid = std::partition( samples.begin() + begin, samples.begin() + end, [&]( uint32_t i ) { return binned.bins[i * numFeatures + bestFeature] <= bestBin; } );
+  const size_t split = mid - samples.begin();
+
+  tree[node].feature   = bestFeature;
+  tree[node].threshold = binned.edges[bestFeature][bestBin];
+  const int left       = xGrowNode( set, binned, weights, samples, begin, split, depth + 1, rng, tree );
+  const int right      = xGrowNode( set, binned, weights, samples, split, end, depth + 1, rng, tree );
+  tree[node].left      = left;
+  tree[node].right     = right;
+
+  return node;
+}
+
+float DTTrainApp::xPredictTree( const DTTrainTree& tree, const float* features )
+{
+  int n = 0;
+  while( tree[n].feature >= 0 )
+  {
+    n = features[tree[n].feature] <= tree[n].threshold ? tree[n].left : tree[n].right;
+  }
+  return tree[n].threshold;
+}
+
+/** Pruning of eval_rf_models.py and get_tree_num.py: trees are added one at a time, each time the one that gives the
+ *  best accuracy on the test samples together with the trees already added, and the best of these forests with at least
+ *  MinTrees trees is kept.
+ */
+void DTTrainApp::xSelectTrees( const std::vector<DTTrainTree>& trees, const DTTrainSet& testSet, const int numFeatures, std::vector<int>& selected, double& fullAccuracy, double& accuracy ) const
+{
+  const int    numTrees = int( trees.size() );
+  const size_t n        = testSet.size();
+
+  selected.clear();
+  if( n == 0 )
+  {
+    for( int t = 0; t < numTrees; t++ )
+    {
+      selected.push_back( t );
+    }
+    fullAccuracy = accuracy = 0.0;
+    return;
+  }
+
+  std::vector<std::vector<float>> prob( numTrees, std::vector<float>( n ) );
+  for( int t = 0; t < numTrees; t++ )
+  {
+    for( size_t i = 0; i < n; i++ )
+    {
+      prob[t][i] = xPredictTree( trees[t], &testSet.features[i * numFeatures] );
+    }
+  }
+
+  auto countCorrect = [&]( const std::vector<double>& sum, const int numSummed )
+  {
+    size_t correct = 0;
+    for( size_t i = 0; i < n; i++ )
+    {
+      correct += ( sum[i] > 0.5 * numSummed ) == ( testSet.labels[i] == 1 );
+    }
+    return double( correct ) / n;
+  };
+
+  std::vector<double> sum( n, 0.0 );
+  for( int t = 0; t < numTrees; t++ )
+  {
+    for( size_t i = 0; i < n; i++ )
+    {
+      sum[i] += prob[t][i];
+    }
+  }
+  fullAccuracy = countCorrect( sum, numTrees );
+
+  std::vector<bool>   used( numTrees, false );
+  std::vector<double> prefixAccuracy;
+  std::vector<double> trial( n );
+  std::fill( sum.begin(), sum.end(), 0.0 );
+  for( int k = 0; k < numTrees; k++ )
+  {
+    int    bestTree = -1;
+    double bestAcc  = -1.0;
+    for( int t = 0; t < numTrees; t++ )
+    {
+      if( used[t] )
+      {
+        continue;
+      }
+      for( size_t i = 0; i < n; i++ )
+      {
+        trial[i] = sum[i] + prob[t][i];
+      }
+      const double acc = countCorrect( trial, k + 1 );
+      if( acc > bestAcc )
+      {
+        bestAcc  = acc;
+        bestTree = t;
+      }
+    }
+    used[bestTree] = true;
+    selected.push_back( bestTree );
+    prefixAccuracy.push_back( bestAcc );
+    for( size_t i = 0; i < n; i++ )
+    {
+      sum[i] += prob[bestTree][i];
+    }
+  }
+
+  const int minTrees = std::min( m_minTrees, numTrees );
+  const int numKept  = int( std::max_element( prefixAccuracy.begin() + minTrees - 1, prefixAccuracy.end() ) - prefixAccuracy.begin() ) + 1;
+  selected.resize( numKept );
+  accuracy = prefixAccuracy[numKept - 1];
+}
+
+/// writes the forest file in the format of DTForest, see DTForest.h
+void DTTrainApp::xWriteForest( const std::vector<std::tuple<ModelKey, std::vector<DTTrainTree>>>& models ) const
+{
+  std::vector<DTForestModelEntry> entries( models.size() );
+  std::vector<uint8_t>            payload;
+  const uint64_t                  payloadOffset = sizeof( DTForestFileHeader ) + models.size() * sizeof( DTForestModelEntry );
+
+  auto append = [&]( const void* data, const size_t size )
+  {
+    const uint64_t offset = payloadOffset + payload.size();
+    payload.insert( payload.end(), (const uint8_t*) data, (const uint8_t*) data + size );
+    return offset;
+  };
+
+  for( size_t m = 0; m < models.size(); m++ )
+  {
+    const ModelKey&                 key   = std::get<0>( models[m] );
+    const std::vector<DTTrainTree>& trees = std::get<1>( models[m] );
+
+    // nodes in pre-order: the left child follows its parent, the right child is found by offset
+    std::vector<uint32_t> roots;
+    std::vector<int32_t>  feature;
+    std::vector<float>    threshold;
+    std::vector<uint32_t> rightOffset;
+    for( const DTTrainTree& tree : trees )
+    {
+      roots.push_back( uint32_t( feature.size() ) );
+      std::vector<std::pair<int, int>> stack( 1, std::make_pair( 0, -1 ) );   // node, position of the parent of a right child
+      while( !stack.empty() )
+      {
+        const int node   = stack.back().first;
+        const int parent = stack.back().second;
+        stack.pop_back();
+        const uint32_t pos = uint32_t( feature.size() );
+        if( parent >= 0 )
+        {
+          rightOffset[parent] = pos - parent;
+        }
+        feature    .push_back( tree[node].feature < 0 ? -1 : tree[node].feature );
+        threshold  .push_back( tree[node].threshold );
+        rightOffset.push_back( 0 );
+        if( tree[node].feature >= 0 )
+        {
+          stack.push_back( std::make_pair( tree[node].right, int( pos ) ) );
+          stack.push_back( std::make_pair( tree[node].left, -1 ) );
+        }
+      }
+    }
+
+    DTForestModelEntry& entry = entries[m];
+    entry.decision          = std::get<0>( key );
+    entry.width             = std::get<1>( key );
+    entry.height            = std::get<2>( key );
+    entry.numFeatures       = std::get<3>( key );
+    entry.numTrees          = uint32_t( roots.size() );
+    entry.numNodes          = uint32_t( feature.size() );
+    entry.treeRootOffset    = append( roots.data(),       roots.size()       * sizeof( uint32_t ) );
+    entry.featureOffset     = append( feature.data(),     feature.size()     * sizeof( int32_t ) );
+    entry.thresholdOffset   = append( threshold.data(),   threshold.size()   * sizeof( float ) );
+    entry.rightOffsetOffset = append( rightOffset.data(), rightOffset.size() * sizeof( uint32_t ) );
+  }
+
+  DTForestFileHeader header;
+  header.magic     = DT_FOREST_MAGIC;
+  header.version   = DT_FOREST_VERSION;
+  header.numModels = uint32_t( models.size() );
+  header.reserved  = 0;
+
+  FILE* file = fopen( m_forestFileName.c_str(), "wb" );
+  CHECK( !file, "Cannot open forest file " << m_forestFileName );
+  bool ok = fwrite( &header, sizeof( header ), 1, file ) == 1;
+  ok &= entries.empty() || fwrite( entries.data(), sizeof( DTForestModelEntry ), entries.size(), file ) == entries.size();
+  ok &= payload.empty() || fwrite( payload.data(), 1, payload.size(), file ) == payload.size();
+  ok &= fclose( file ) == 0;
+  CHECK( !ok, "Cannot write forest file " << m_forestFileName );
+
+  msg( INFO, "\nWrote %d models to %s\n", (int) models.size(), m_forestFileName.c_str() );
+}
+
+//! \}
@@ -0,0 +1,119 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTTrainApp.h
+    \brief    DT forest training application class (header)
+*/
+
+#ifndef __DTTRAINAPP__
+#define __DTTRAINAPP__
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include "CommonLib/CommonDef.h"
+#include "EncoderLib/DTForest.h"
+
+#include "DTTrainAppCfg.h"
+
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+//! \ingroup DTTrainApp
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// labelled samples of one model, i.e. one decision and block size
+struct DTTrainSet
+{
+  std::vector<float>   features;   ///< numFeatures per sample
+  std::vector<uint8_t> labels;
+  std::vector<float>   weights;    ///< RD cost difference between both choices
+
+  size_t size() const { return labels.size(); }
+};
+
+/// tree node while training, leaves have feature < 0 and store the probability of class 1 in threshold
+struct DTTrainNode
+{
+  int   feature;
+  float threshold;
+  int   left;
+  int   right;
+};
+
+typedef std::vector<DTTrainNode> DTTrainTree;
+
+/// trains the forests of the DT decisions on a dataset collected by the encoder (-dtm collect) and
+/// writes them as a forest file for -dtf
+class DTTrainApp : public DTTrainAppCfg
+{
+public:
+  DTTrainApp();
+  virtual ~DTTrainApp() {}
+
+  int  train();   ///< main training function, returns the number of models written
+
+private:
+  typedef std::tuple<int, int, int, int>                          ModelKey;   // decision, width, height, numFeatures
+  typedef std::tuple<int, int, int, int, int, int, uint64_t>     BlockKey;   // dataset, poc, x, y, width, height, split series
+
+  struct BinnedSet
+  {
+    int                             numFeatures;
+    std::vector<std::vector<float>> edges;   ///< per feature: a sample is in the first bin whose edge is not below it
+    std::vector<uint8_t>            bins;    ///< numFeatures per sample
+  };
+
+  void   xReadDatasets  ( std::map<ModelKey, DTTrainSet>& sets );
+  void   xSplitSet      ( const DTTrainSet& set, const int numFeatures, DTTrainSet& trainSet, DTTrainSet& testSet );
+  void   xBinSet        ( const DTTrainSet& set, const int numFeatures, BinnedSet& binned ) const;
+  void   xGrowTree      ( const DTTrainSet& set, const BinnedSet& binned, const int seed, DTTrainTree& tree ) const;
+  int    xGrowNode      ( const DTTrainSet& set, const BinnedSet& binned, std::vector<float>& weights, std::vector<uint32_t>& samples,
+                          const size_t begin, const size_t end, const int depth, std::mt19937& rng, DTTrainTree& tree ) const;
+  static float xPredictTree( const DTTrainTree& tree, const float* features );
+  void   xSelectTrees   ( const std::vector<DTTrainTree>& trees, const DTTrainSet& testSet, const int numFeatures, std::vector<int>& selected, double& fullAccuracy, double& accuracy ) const;
+  void   xWriteForest   ( const std::vector<std::tuple<ModelKey, std::vector<DTTrainTree>>>& models ) const;
+
+  std::mt19937 m_rng;
+};
+
+//! \}
+
+#endif // __DTTRAINAPP__
@@ -0,0 +1,168 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTTrainAppCfg.cpp
+    \brief    DT forest training configuration class
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "DTTrainAppCfg.h"
+#include "Utilities/program_options_lite.h"
+
+using namespace std;
+namespace po = df::program_options_lite;
+
+//! \ingroup DTTrainApp
+//! \{
+
+// ====================================================================================================================
+// Public member functions
+// ====================================================================================================================
+
+/** \param argc number of arguments
+    \param argv array of arguments
+ */
+bool DTTrainAppCfg::parseCfg( int argc, char* argv[] )
+{
+  bool do_help = false;
+  int warnUnknowParameter = 0;
+  string datasetList;
+  po::Options opts;
+  opts.addOptions()
+
+  ("help",                      do_help,                               false,      "this help text")
+  ("Datasets,i",                datasetList,                           string(""), "comma-separated dataset names, read from split_features_<name>.bin and split_cost_<name>.bin")
+  ("DatasetPath,p",             m_datasetPath,                         string(""), "folder of the dataset files")
+  ("ForestFile,o",              m_forestFileName,                      string("dt_forest.bin"), "output forest file, read by the encoder with -dtf")
+  ("NumTrees,t",                m_numTrees,                            40,         "trees trained per block size")
+  ("MinTrees",                  m_minTrees,                            10,         "smallest number of trees kept by the pruning")
+  ("MaxDepth",                  m_maxDepth,                            20,         "maximum depth of a tree")
+  ("MinSamplesSplit",           m_minSamplesSplit,                     100,        "smallest number of samples of a node that is split")
+  ("NumBins",                   m_numBins,                             256,        "histogram bins per feature (at most 256)")
+  ("Threads,j",                 m_numThreads,                          0,          "training threads, 0 for one per hardware thread")
+  ("MinSamples",                m_minSamples,                          1000,       "block sizes with fewer samples after balancing get no model")
+  ("MaxSamples",                m_maxSamples,                          0,          "samples used per block size, 0 for all")
+  ("BalanceClasses",            m_balanceClasses,                      true,       "use as many samples of both classes")
+  ("TestFraction",              m_testFraction,                        0.2,        "fraction of the samples held out to select the trees")
+  ("Seed",                      m_seed,                                1,          "seed of the sampling and of the trees")
+
+  ("WarnUnknowParameter,w",     warnUnknowParameter,                   0,          "warn for unknown configuration parameters instead of failing")
+  ;
+
+  po::setDefaults(opts);
+  po::ErrorReporter err;
+  const list<const char*>& argv_unhandled = po::scanArgv(opts, argc, (const char**) argv, err);
+
+  for (list<const char*>::const_iterator it = argv_unhandled.begin(); it != argv_unhandled.end(); it++)
+  {
+    std::cerr << "Unhandled argument ignored: "<< *it << std::endl;
+  }
+
+  if (argc == 1 || do_help)
+  {
+    po::doHelp(cout, opts);
+    return false;
+  }
+
+  if (err.is_errored)
+  {
+    if (!warnUnknowParameter)
+    {
+      /* errors have already been reported to stderr */
+      return false;
+    }
+  }
+
+  istringstream names( datasetList );
+  string         name;
+  while( getline( names, name, ',' ) )
+  {
+    if( !name.empty() )
+    {
+      m_datasetNames.push_back( name );
+    }
+  }
+  if (m_datasetNames.empty())
+  {
+    std::cerr << "No dataset specified, aborting" << std::endl;
+    return false;
+  }
+  if (m_numTrees < 1 || m_minTrees < 1 || m_maxDepth < 1 || m_minSamplesSplit < 2 || m_numBins < 2 || m_numBins > 256)
+  {
+    std::cerr << "Invalid forest parameters, aborting" << std::endl;
+    return false;
+  }
+  if (m_testFraction < 0.0 || m_testFraction >= 1.0)
+  {
+    std::cerr << "TestFraction has to be in [0, 1), aborting" << std::endl;
+    return false;
+  }
+  if (m_numThreads <= 0)
+  {
+    m_numThreads = std::max<int>( 1, std::thread::hardware_concurrency() );
+  }
+  if (!m_datasetPath.empty() && m_datasetPath.back() != '/')
+  {
+    m_datasetPath += '/';
+  }
+
+  return true;
+}
+
+DTTrainAppCfg::DTTrainAppCfg()
+: m_datasetNames()
+, m_datasetPath()
+, m_forestFileName()
+, m_numTrees( 40 )
+, m_minTrees( 10 )
+, m_maxDepth( 20 )
+, m_minSamplesSplit( 100 )
+, m_numBins( 256 )
+, m_numThreads( 1 )
+, m_minSamples( 1000 )
+, m_maxSamples( 0 )
+, m_balanceClasses( true )
+, m_testFraction( 0.2 )
+, m_seed( 1 )
+{
+}
+
+DTTrainAppCfg::~DTTrainAppCfg()
+{
+}
+
+//! \}
@@ -0,0 +1,84 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTTrainAppCfg.h
+    \brief    DT forest training configuration class (header)
+*/
+
+#ifndef __DTTRAINAPPCFG__
+#define __DTTRAINAPPCFG__
+
+#if _MSC_VER > 1000
+#pragma once
+#endif // _MSC_VER > 1000
+
+#include "CommonLib/CommonDef.h"
+#include <string>
+#include <vector>
+
+//! \ingroup DTTrainApp
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// DT forest training configuration class
+class DTTrainAppCfg
+{
+protected:
+  std::vector<std::string> m_datasetNames;      ///< datasets split_features_<name>.bin and split_cost_<name>.bin
+  std::string   m_datasetPath;                    ///< folder of the dataset files
+  std::string   m_forestFileName;                 ///< output forest file
+  int           m_numTrees;                       ///< trees trained per model
+  int           m_minTrees;                       ///< smallest number of trees kept by the pruning
+  int           m_maxDepth;
+  int           m_minSamplesSplit;                ///< nodes with fewer samples become leaves
+  int           m_numBins;                        ///< histogram bins per feature
+  int           m_numThreads;
+  int           m_minSamples;                     ///< block sizes with fewer samples after balancing get no model
+  int           m_maxSamples;                     ///< samples kept per block size after balancing, 0 for all
+  bool          m_balanceClasses;                 ///< as many samples of both classes
+  double        m_testFraction;                   ///< held-out samples on which the trees are selected
+  int           m_seed;
+
+public:
+  DTTrainAppCfg();
+  virtual ~DTTrainAppCfg();
+
+  bool  parseCfg        ( int argc, char* argv[] );   ///< initialize option class from configuration
+};
+
+//! \}
+
+#endif  // __DTTRAINAPPCFG__
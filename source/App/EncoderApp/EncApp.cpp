@@ -48,11 +48,6 @@
 
 using namespace std;
 
-#if COLLECT_DATASET
-std::string filename_arg;
-int qp_arg;
-#endif
-
 //! \ingroup EncoderApp
 //! \{
 
@@ -241,8 +236,30 @@ void EncApp::xInitLibCfg()
     m_cEncLib.setSubProfile(i, m_subProfile[i]);
   }
 
-#if RF_TH_CMD
+#if FEATURE_TEST
+  m_cEncLib.setDTMode                                            ( m_dtMode );
   m_cEncLib.setThresholdDT                                         (m_threshold_dt);
+  m_cEncLib.setThresholdDTFileName                               ( m_thresholdDTFileName );
+  m_cEncLib.setDTAuditFraction                                   ( m_dtAuditFraction );
+  m_cEncLib.setDTTargetRDLoss                                    ( m_dtTargetRDLoss );
+  m_cEncLib.setDTTargetPruneRate                                 ( m_dtTargetPruneRate );
+  m_cEncLib.setDTTimeBudget                                      ( m_dtTimeBudget );
+  m_cEncLib.setDTForestFileName                                  ( m_dtForestFileName );
+  m_cEncLib.setDTMotionThreads                                   ( m_dtMotionThreads );
+  m_cEncLib.setDTMotionLookAhead                                 ( m_dtMotionLookAhead );
+  m_cEncLib.setDTMotionHierarchical                              ( m_dtMotionHierarchical );
+  m_cEncLib.setDTForestBenchmark                                 ( m_dtForestBenchmark );
+  m_cEncLib.setDTTelemetry                                       ( m_dtTelemetry );
+  m_cEncLib.setDTShadow                                          ( m_dtShadow );
+  m_cEncLib.setDTSplitOrder                                      ( DTSplitOrder( m_dtSplitOrder ) );
+  m_cEncLib.setDTSplitOrderMargin                                ( m_dtSplitOrderMargin );
+  // the dataset files are named after the input sequence and the QP, e.g. split_features_<yuvname>_QP_<qp>.bin
+  const std::string inputName = m_inputFileName.substr( m_inputFileName.find_last_of( "/\\" ) + 1 );
+  m_cEncLib.setDTDatasetName                                     ( inputName.substr( 0, inputName.find_last_of( "." ) ) + "_QP_" + std::to_string( m_iQP ) );
+  m_cEncLib.setDTSamplePocStride                                 ( m_dtSamplePocStride );
+  m_cEncLib.setDTSamplePocs                                      ( m_dtSamplePocs );
+  m_cEncLib.setDTSampleCtuFraction                               ( m_dtSampleCtuFraction );
+  m_cEncLib.setDTSampleBlockCap                                  ( m_dtSampleBlockCap );
 #endif
 
 
@@ -1125,11 +1142,6 @@ void EncApp::xCreateLib( std::list<PelUnitBuf*>& recBufList, const int layerId )
 {
   // Video I/O
 
-#if COLLECT_DATASET
-  filename_arg = m_inputFileName;
-  qp_arg = m_iQP;
-#endif  
-
   m_cVideoIOYuvInputFile.open( m_inputFileName,     false, m_inputBitDepth, m_MSBExtendedBitDepth, m_internalBitDepth );  // read  mode
 #if EXTENSION_360_VIDEO
   m_cVideoIOYuvInputFile.skipFrames(m_FrameSkip, m_inputFileWidth, m_inputFileHeight, m_InputChromaFormatIDC);
@@ -1232,6 +1244,12 @@ void EncApp::createLib( const int layerIdx )
       m_aiPad, m_bClipInputVideoToRec709Range, m_inputFileName, m_chromaFormatIDC,
       m_inputColourSpaceConvert, m_iQP, m_gopBasedTemporalFilterStrengths,
       m_gopBasedTemporalFilterFutureReference );
+#if FEATURE_TEST
+    if( m_dtMode != DT_MODE_OFF )
+    {
+      m_temporalFilter.setMotionCache( m_cEncLib.getMotionCache() );
+    }
+#endif
   }
 }
 
@@ -275,6 +275,21 @@ strToCostMode[] =
   {"mixed_lossless_lossy",      COST_MIXED_LOSSLESS_LOSSY_CODING}
 };
 
+#if FEATURE_TEST
+static const struct MapStrToDTMode
+{
+  const char* str;
+  DTMode      value;
+}
+strToDTMode[] =
+{
+  {"off",                       DT_MODE_OFF},
+  {"infer",                     DT_MODE_INFER},
+  {"collect",                   DT_MODE_COLLECT},
+  {"infer+collect",             DT_MODE_INFER_COLLECT}
+};
+#endif
+
 static const struct MapStrToScalingListMode
 {
   const char* str;
@@ -348,6 +363,13 @@ static inline istream& operator >> (istream &in, CostMode &mode)
   return readStrToEnum(strToCostMode, sizeof(strToCostMode)/sizeof(*strToCostMode), in, mode);
 }
 
+#if FEATURE_TEST
+static inline istream& operator >> (istream &in, DTMode &mode)
+{
+  return readStrToEnum(strToDTMode, sizeof(strToDTMode)/sizeof(*strToDTMode), in, mode);
+}
+#endif
+
 static inline istream& operator >> (istream &in, ScalingListMode &mode)
 {
   return readStrToEnum(strToScalingListMode, sizeof(strToScalingListMode)/sizeof(*strToScalingListMode), in, mode);
@@ -613,6 +635,9 @@ bool EncAppCfg::parseCfg( int argc, char* argv[] )
   SMultiValueInput<int>  cfg_lumaLeveltoDQPMappingQP         (-MAX_QP, MAX_QP,                    0, LUMA_LEVEL_TO_DQP_LUT_MAXSIZE, defaultLumaLevelTodQp_QpChangePoints,   sizeof(defaultLumaLevelTodQp_QpChangePoints  )/sizeof(int));
   SMultiValueInput<int>  cfg_lumaLeveltoDQPMappingLuma       (0, std::numeric_limits<int>::max(), 0, LUMA_LEVEL_TO_DQP_LUT_MAXSIZE, defaultLumaLevelTodQp_LumaChangePoints, sizeof(defaultLumaLevelTodQp_LumaChangePoints)/sizeof(int));
   uint32_t lumaLevelToDeltaQPMode;
+#endif
+#if FEATURE_TEST
+  SMultiValueInput<int>  cfg_dtSamplePocs                    (0, std::numeric_limits<int>::max(), 0, std::numeric_limits<int>::max());
 #endif
   const int qpInVals[] = { 25, 33, 43 };                // qpInVal values used to derive the chroma QP mapping table used in VTM-5.0
   const int qpOutVals[] = { 25, 32, 37 };               // qpOutVal values used to derive the chroma QP mapping table used in VTM-5.0
@@ -732,8 +757,27 @@ bool EncAppCfg::parseCfg( int argc, char* argv[] )
   ("BitstreamFile,b",                                 m_bitstreamFileName,                         string(""), "Bitstream output file name")
   ("ReconFile,o",                                     m_reconFileName,                             string(""), "Reconstructed YUV output file name")
  
-#if RF_TH_CMD     
+#if FEATURE_TEST
+  ("DTMode,-dtm",                                     m_dtMode,                                 DT_MODE_INFER, "DT partition mode: 'off' (baseline search), 'infer' (pruned by the decision trees), 'collect' (write the dataset) or 'infer+collect'")
   ("ThresholdDT,-thdt",                               m_threshold_dt,                             0.9f, "The threshold for the dt voting")
+  ("ThresholdDTFile,-thdtf",                          m_thresholdDTFileName,                       string(""), "Text file of DT thresholds per decision, block size and temporal layer, overriding ThresholdDT")
+  ("DTAuditFraction,-dtaf",                           m_dtAuditFraction,                                  0.0, "Fraction of the confident DT decisions searched without pruning to measure their RD loss")
+  ("DTTargetRDLoss,-dttl",                            m_dtTargetRDLoss,                                   0.0, "Adapt the DT thresholds per block size to this relative RD cost loss, measured on the audited CUs (0: off)")
+  ("DTTargetPruneRate,-dttp",                         m_dtTargetPruneRate,                                0.0, "Adapt the DT thresholds per block size to prune this fraction of the DT decisions (0: off)")
+  ("DTTimeBudget,-dttb",                              m_dtTimeBudget,                                     0.0, "Steer the DT thresholds per CTU to code each inter picture within this time in milliseconds (0: off)")
+  ("DTForestFile,-dtf",                               m_dtForestFileName,                          string(""), "Binary DT forest model file (default: compiled-in forest)")
+  ("DTMotionThreads,-dtmt",                           m_dtMotionThreads,                                    1, "Number of threads of the DT motion field pre-analysis")
+  ("DTMotionLookAhead,-dtla",                         m_dtMotionLookAhead,                              false, "Estimate the DT motion fields between original pictures on a background thread ahead of coding")
+  ("DTMotionHierarchical,-dthme",                     m_dtMotionHierarchical,                           false, "Coarse-to-fine DT motion field search seeded from neighbouring MVs")
+  ("DTForestBenchmark,-dtfb",                         m_dtForestBenchmark,                                  0, "Time the DT forest file against the compiled-in forest on each predicted CU, repeating every prediction this many times (0: off)")
+  ("DTTelemetry,-dtst",                               m_dtTelemetry,                                    false, "Print the DT decision outcomes, skipped checks and time per decision and block size, per picture and per sequence")
+  ("DTShadow,-dtsh",                                  m_dtShadow,                                       false, "Run the full search while predicting every DT decision, and print their confusion matrices and the RD cost the pruning would have lost")
+  ("DTSplitOrder,-dtso",                              m_dtSplitOrder,                                       0, "Order of the split modes of a CU: 0 fixed, 1 from the most to the least likely by the DT probabilities, 2 ordered with early termination of the remaining split modes")
+  ("DTSplitOrderMargin,-dtsom",                       m_dtSplitOrderMargin,                               0.1, "Relative RD cost gain over the best tested split of its direction a split mode is expected to reach if the DT is certain of it, for the early termination of DTSplitOrder 2")
+  ("DTSamplePOCStride,-dtps",                         m_dtSamplePocStride,                                  0, "Collect the DT dataset on inter pictures whose POC is a multiple of this stride, 0 for the pictures of the published dataset")
+  ("DTSamplePOCs,-dtpl",                              cfg_dtSamplePocs,                      cfg_dtSamplePocs, "Explicit list of POCs to collect the DT dataset on, overrides DTSamplePOCStride")
+  ("DTSampleCTUFraction,-dtcf",                       m_dtSampleCtuFraction,                              1.0, "Fraction of the CTUs of a sampled picture the DT dataset is collected on")
+  ("DTSampleBlockCap,-dtbc",                          m_dtSampleBlockCap,                                   0, "Maximum number of blocks of each size per picture in the DT dataset, 0 for no limit")
 #endif
 
     
@@ -1842,6 +1886,10 @@ bool EncAppCfg::parseCfg( int argc, char* argv[] )
     msg(WARNING, "*************************************************************************\n");
   }
 
+#if FEATURE_TEST
+  m_dtSamplePocs = cfg_dtSamplePocs.values;
+#endif
+
   if (m_costMode == COST_LOSSLESS_CODING && m_mixedLossyLossless)
   {
     m_sliceLosslessArray.resize(cfgSliceLosslessArray.values.size());
@@ -2710,6 +2758,30 @@ bool EncAppCfg::xCheckParameter()
 
   xConfirmPara( m_numWppThreads != 1, "ENABLE_WPP_PARALLELISM is disabled, numWppThreads has to be 1" );
   xConfirmPara( m_ensureWppBitEqual, "ENABLE_WPP_PARALLELISM is disabled, cannot ensure being WPP bit-equal" );
+#if FEATURE_TEST
+  xConfirmPara( m_dtMotionThreads < 1, "Number of DT motion field threads cannot be smaller than 1" );
+  xConfirmPara( m_dtForestBenchmark < 0, "DT forest benchmark repetitions cannot be negative" );
+  xConfirmPara( m_dtForestBenchmark > 0 && m_dtForestFileName.empty(), "DT forest benchmark requires a DT forest file" );
+  xConfirmPara( m_dtForestBenchmark > 0 && !( m_dtMode & DT_MODE_INFER ), "DT forest benchmark requires a DT mode with inference" );
+  xConfirmPara( m_dtTelemetry && !( m_dtMode & DT_MODE_INFER ), "DT telemetry requires a DT mode with inference" );
+  xConfirmPara( m_dtShadow && !( m_dtMode & DT_MODE_INFER ), "DT shadow mode requires a DT mode with inference" );
+  xConfirmPara( m_dtShadow && ( m_dtTargetRDLoss > 0.0 || m_dtTargetPruneRate > 0.0 || m_dtTimeBudget > 0.0 ), "DT shadow mode prunes nothing and cannot be combined with the DT threshold control or time budget" );
+  xConfirmPara( m_dtSplitOrder < DT_SPLIT_ORDER_OFF || m_dtSplitOrder > DT_SPLIT_ORDER_TERMINATE, "DT split order has to be 0, 1 or 2" );
+  xConfirmPara( m_dtSplitOrder != DT_SPLIT_ORDER_OFF && !( m_dtMode & DT_MODE_INFER ), "DT split order requires a DT mode with inference" );
+  xConfirmPara( m_dtSplitOrder != DT_SPLIT_ORDER_OFF && m_dtShadow, "DT shadow mode runs the full search in the fixed order and cannot be combined with the DT split order" );
+  xConfirmPara( m_dtSplitOrderMargin < 0.0 || m_dtSplitOrderMargin > 1.0, "DT split order margin has to be in [0, 1]" );
+  xConfirmPara( m_dtAuditFraction < 0.0 || m_dtAuditFraction > 1.0, "DT audit fraction has to be in [0, 1]" );
+  xConfirmPara( m_dtTargetRDLoss < 0.0, "DT target RD loss cannot be negative" );
+  xConfirmPara( m_dtTargetPruneRate < 0.0 || m_dtTargetPruneRate > 1.0, "DT target prune rate has to be in [0, 1]" );
+  xConfirmPara( m_dtTargetRDLoss > 0.0 && m_dtTargetPruneRate > 0.0, "Only one of DT target RD loss and DT target prune rate can be set" );
+  xConfirmPara( m_dtTargetRDLoss > 0.0 && m_dtAuditFraction == 0.0, "DT target RD loss requires a DT audit fraction" );
+  xConfirmPara( ( m_dtTargetRDLoss > 0.0 || m_dtTargetPruneRate > 0.0 ) && !( m_dtMode & DT_MODE_INFER ), "DT threshold control requires a DT mode with inference" );
+  xConfirmPara( m_dtTimeBudget < 0.0, "DT time budget cannot be negative" );
+  xConfirmPara( m_dtTimeBudget > 0.0 && !( m_dtMode & DT_MODE_INFER ), "DT time budget requires a DT mode with inference" );
+  xConfirmPara( m_dtSamplePocStride < 0, "DT dataset POC stride cannot be negative" );
+  xConfirmPara( m_dtSampleCtuFraction <= 0.0 || m_dtSampleCtuFraction > 1.0, "DT dataset CTU fraction has to be in (0, 1]" );
+  xConfirmPara( m_dtSampleBlockCap < 0, "DT dataset block cap cannot be negative" );
+#endif
 
 
 #if SHARP_LUMA_DELTA_QP && ENABLE_QPA
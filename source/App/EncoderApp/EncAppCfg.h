@@ -86,8 +86,27 @@ protected:
   std::string m_bitstreamFileName;                            ///< output bitstream file
   std::string m_reconFileName;                                ///< output reconstruction file
 
-#if RF_TH_CMD
+#if FEATURE_TEST
+  DTMode      m_dtMode;                                       ///< DT dataset collection and/or split pruning
   float m_threshold_dt;
+  std::string m_thresholdDTFileName;                          ///< DT thresholds per decision, block size and temporal layer
+  double      m_dtAuditFraction;                              ///< fraction of the confident DT decisions searched without pruning
+  double      m_dtTargetRDLoss;                               ///< relative RD loss the DT thresholds are adapted to, 0 for off
+  double      m_dtTargetPruneRate;                            ///< fraction of pruned DT decisions the thresholds are adapted to, 0 for off
+  double      m_dtTimeBudget;                                 ///< CTU coding time per inter picture in ms the DT thresholds are steered to, 0 for off
+  std::string m_dtForestFileName;                             ///< runtime DT forest model file, compiled-in forest if empty
+  int         m_dtMotionThreads;                              ///< number of threads of the DT motion field pre-analysis
+  bool        m_dtMotionLookAhead;                            ///< DT motion fields estimated on the original references ahead of coding
+  bool        m_dtMotionHierarchical;                         ///< coarse-to-fine DT motion field search
+  int         m_dtForestBenchmark;                            ///< repetitions of the timed DT forest predictions, 0 for off
+  bool        m_dtTelemetry;                                  ///< DT decision statistics per picture and per sequence
+  bool        m_dtShadow;                                     ///< DT decisions evaluated against the full search without pruning
+  int         m_dtSplitOrder;                                 ///< split modes ordered by the DT probabilities, with early termination if 2
+  double      m_dtSplitOrderMargin;                           ///< relative RD cost gain expected of a certain split mode by the early termination
+  int         m_dtSamplePocStride;                            ///< DT dataset collected on POCs that are multiples of the stride, 0 for the published selection
+  std::vector<int> m_dtSamplePocs;                            ///< DT dataset collected on these POCs, overrides the stride
+  double      m_dtSampleCtuFraction;                          ///< fraction of the CTUs of a sampled picture
+  int         m_dtSampleBlockCap;                             ///< blocks of each size per picture, 0 for no limit
 #endif
 
 
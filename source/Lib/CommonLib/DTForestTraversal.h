@@ -0,0 +1,66 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTForestTraversal.h
+ *  \brief    Declaration of DTForestTraversal class
+ */
+
+#ifndef __DTFORESTTRAVERSAL__
+#define __DTFORESTTRAVERSAL__
+
+#include "CommonDef.h"
+
+//! \ingroup CommonLib
+//! \{
+
+/// walks all trees of one packed forest (pre-order nodes, left child is the next node) and returns the mean leaf value
+class DTForestTraversal
+{
+public:
+  double( *m_traverseForest ) ( const int32_t* feature, const float* threshold, const uint32_t* rightOffset, const uint32_t* treeRoot, const int numTrees, const float* features );
+
+  static double xTraverseForest( const int32_t* feature, const float* threshold, const uint32_t* rightOffset, const uint32_t* treeRoot, const int numTrees, const float* features );
+
+  DTForestTraversal();
+  ~DTForestTraversal() {}
+
+#ifdef TARGET_SIMD_X86
+  void initDTForestTraversalX86();
+  template <X86_VEXT vext>
+  void _initDTForestTraversalX86();
+#endif
+};
+
+//! \}
+
+#endif
@@ -0,0 +1,160 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     FeatureIntegrals.cpp
+ *  \brief    Summed-area tables of the original luma used by the DT partitioning features
+ */
+
+#include "FeatureIntegrals.h"
+
+//! \ingroup CommonLib
+//! \{
+
+void featureRowCore( const Pel* src, const int srcStride, const int width, const bool hasAbove, const bool hasBelow, uint32_t* sample, uint32_t* sqSample, uint32_t* gradHor, uint32_t* gradVer, uint32_t* sobel )
+{
+  const Pel* above    = src - srcStride;
+  const Pel* below    = src + srcStride;
+  const bool hasSobel = hasAbove && hasBelow;
+
+  for( int x = 0; x < width; x++ )
+  {
+    const int p = src[x];
+
+    sample  [x] = p;
+    sqSample[x] = p * p;
+    gradHor [x] = x < width - 1 ? abs( src[x + 1] - p ) : 0;
+    gradVer [x] = hasBelow ? abs( below[x] - p ) : 0;
+    sobel   [x] = 0;
+
+    if( hasSobel && x > 0 && x < width - 1 )
+    {
+      const int gx = ( below[x - 1] + 2 * below[x]   + below[x + 1] ) - ( above[x - 1] + 2 * above[x]   + above[x + 1] );
+      const int gy = ( above[x + 1] + 2 * src  [x + 1] + below[x + 1] ) - ( above[x - 1] + 2 * src  [x - 1] + below[x - 1] );
+
+      sobel[x] = gx * gx + gy * gy;
+    }
+  }
+}
+
+template<typename T>
+void integrateCore( const uint32_t* src, const T* prev, T* dst, const int width )
+{
+  T rowSum = 0;
+
+  for( int x = 0; x < width; x++ )
+  {
+    rowSum += src[x];
+    dst[x]  = prev[x] + rowSum;
+  }
+}
+
+FeatureIntegralOps::FeatureIntegralOps()
+{
+  featureRow  = featureRowCore;
+  integrate32 = integrateCore<uint32_t>;
+  integrate64 = integrateCore<uint64_t>;
+}
+
+FeatureIntegralOps g_featureIntegralOP = FeatureIntegralOps();
+
+FeatureIntegrals::FeatureIntegrals()
+  : m_width ( 0 )
+  , m_height( 0 )
+  , m_stride( 0 )
+{
+}
+
+void FeatureIntegrals::create( const int width, const int height )
+{
+  m_width  = width;
+  m_height = height;
+  m_stride = width + 1;
+
+  // the first row and column stay zero, compute() only writes the inner part
+  const size_t size = size_t( m_stride ) * ( height + 1 );
+
+  m_sum    .assign( size, 0 );
+  m_sqSum  .assign( size, 0 );
+  m_gradHor.assign( size, 0 );
+  m_gradVer.assign( size, 0 );
+  m_sobel  .assign( size, 0 );
+
+  m_rowTerms.resize( 5 * width );
+}
+
+void FeatureIntegrals::destroy()
+{
+  m_width  = 0;
+  m_height = 0;
+  m_stride = 0;
+
+  std::vector<uint32_t>().swap( m_sum );
+  std::vector<uint64_t>().swap( m_sqSum );
+  std::vector<uint32_t>().swap( m_gradHor );
+  std::vector<uint32_t>().swap( m_gradVer );
+  std::vector<uint64_t>().swap( m_sobel );
+  std::vector<uint32_t>().swap( m_rowTerms );
+}
+
+void FeatureIntegrals::compute( const CPelBuf& org, const int bitDepth )
+{
+  // the squared Sobel magnitude of one sample has to fit into 32 bits
+  CHECK( bitDepth > 12, "Feature integrals are limited to a bit depth of 12" );
+
+  if( org.width != m_width || org.height != m_height )
+  {
+    create( org.width, org.height );
+  }
+
+  uint32_t* sample   = &m_rowTerms[0];
+  uint32_t* sqSample = sample   + m_width;
+  uint32_t* gradHor  = sqSample + m_width;
+  uint32_t* gradVer  = gradHor  + m_width;
+  uint32_t* sobel    = gradVer  + m_width;
+
+  for( int y = 0; y < m_height; y++ )
+  {
+    const int prevRow = y * m_stride + 1;
+    const int currRow = prevRow + m_stride;
+
+    g_featureIntegralOP.featureRow( org.bufAt( 0, y ), org.stride, m_width, y > 0, y < m_height - 1, sample, sqSample, gradHor, gradVer, sobel );
+
+    g_featureIntegralOP.integrate32( sample,   &m_sum    [prevRow], &m_sum    [currRow], m_width );
+    g_featureIntegralOP.integrate64( sqSample, &m_sqSum  [prevRow], &m_sqSum  [currRow], m_width );
+    g_featureIntegralOP.integrate32( gradHor,  &m_gradHor[prevRow], &m_gradHor[currRow], m_width );
+    g_featureIntegralOP.integrate32( gradVer,  &m_gradVer[prevRow], &m_gradVer[currRow], m_width );
+    g_featureIntegralOP.integrate64( sobel,    &m_sobel  [prevRow], &m_sobel  [currRow], m_width );
+  }
+}
+
+//! \}
@@ -0,0 +1,125 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     FeatureIntegrals.h
+ *  \brief    Summed-area tables of the original luma used by the DT partitioning features
+ */
+
+#ifndef __FEATUREINTEGRALS__
+#define __FEATUREINTEGRALS__
+
+#include "CommonDef.h"
+#include "Unit.h"
+
+#include <vector>
+
+//! \ingroup CommonLib
+//! \{
+
+/// kernels building the integral images row by row
+struct FeatureIntegralOps
+{
+  FeatureIntegralOps();
+
+#if ENABLE_SIMD_OPT_FEATURES && defined(TARGET_SIMD_X86)
+  void initFeatureIntegralOpsX86();
+  template<X86_VEXT vext>
+  void _initFeatureIntegralOpsX86();
+#endif
+
+  /// per-sample terms of one row: sample, squared sample, |dx|, |dy| and squared Sobel magnitude (zero where a neighbour is missing)
+  void ( *featureRow )  ( const Pel* src, const int srcStride, const int width, const bool hasAbove, const bool hasBelow, uint32_t* sample, uint32_t* sqSample, uint32_t* gradHor, uint32_t* gradVer, uint32_t* sobel );
+  /// one row of a summed-area table: dst[x] = prev[x] + src[0] + ... + src[x]
+  void ( *integrate32 ) ( const uint32_t* src, const uint32_t* prev, uint32_t* dst, const int width );
+  void ( *integrate64 ) ( const uint32_t* src, const uint64_t* prev, uint64_t* dst, const int width );
+};
+
+extern FeatureIntegralOps g_featureIntegralOP;
+
+void featureRowCore( const Pel* src, const int srcStride, const int width, const bool hasAbove, const bool hasBelow, uint32_t* sample, uint32_t* sqSample, uint32_t* gradHor, uint32_t* gradVer, uint32_t* sobel );
+
+/// summed-area tables of one luma picture: samples, squared samples, |dx|, |dy| and squared Sobel magnitude
+/// all rectangle sums are taken in picture coordinates over [x, x + w) x [y, y + h)
+/// the 32-bit tables wrap around on large pictures, rectangle sums stay exact as long as they fit into 32 bits (CUs up to 128x128)
+class FeatureIntegrals
+{
+public:
+  FeatureIntegrals();
+  ~FeatureIntegrals() { destroy(); }
+
+  void     create      ( const int width, const int height );
+  void     destroy     ();
+  void     compute     ( const CPelBuf& org, const int bitDepth );
+
+  int      getWidth    ()                                                             const { return m_width;  }
+  int      getHeight   ()                                                             const { return m_height; }
+
+  /// sum of the samples
+  uint32_t getSum      ( const int x, const int y, const int w, const int h )          const { return xRectSum( m_sum,     x, y, w, h ); }
+  /// sum of the squared samples
+  uint64_t getSqSum    ( const int x, const int y, const int w, const int h )          const { return xRectSum( m_sqSum,   x, y, w, h ); }
+  /// sum of |p(x + 1, y) - p(x, y)|, zero in the last picture column
+  uint32_t getGradHor  ( const int x, const int y, const int w, const int h )          const { return xRectSum( m_gradHor, x, y, w, h ); }
+  /// sum of |p(x, y + 1) - p(x, y)|, zero in the last picture row
+  uint32_t getGradVer  ( const int x, const int y, const int w, const int h )          const { return xRectSum( m_gradVer, x, y, w, h ); }
+  /// sum of Gx^2 + Gy^2 of the 3x3 Sobel operator centred on each sample, zero on the picture border
+  uint64_t getSobel    ( const int x, const int y, const int w, const int h )          const { return xRectSum( m_sobel,   x, y, w, h ); }
+
+private:
+  template<typename T>
+  T        xRectSum    ( const std::vector<T>& sat, const int x, const int y, const int w, const int h ) const
+  {
+    CHECKD( x < 0 || y < 0 || x + w > m_width || y + h > m_height, "Integral rectangle outside of the picture" );
+
+    const T* top = &sat[y * m_stride + x];
+    const T* bot = top + h * m_stride;
+
+    return bot[w] - bot[0] - top[w] + top[0];
+  }
+
+  int                   m_width;
+  int                   m_height;
+  int                   m_stride;
+
+  std::vector<uint32_t> m_sum;
+  std::vector<uint64_t> m_sqSum;
+  std::vector<uint32_t> m_gradHor;
+  std::vector<uint32_t> m_gradVer;
+  std::vector<uint64_t> m_sobel;
+
+  std::vector<uint32_t> m_rowTerms;
+};
+
+//! \}
+
+#endif
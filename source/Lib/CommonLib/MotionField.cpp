@@ -0,0 +1,128 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     MotionField.cpp
+ *  \brief    Compact per-4x4 motion field of the original luma used by the DT partitioning features
+ */
+
+#include "MotionField.h"
+
+#include <algorithm>
+
+//! \ingroup CommonLib
+//! \{
+
+MotionField::MotionField()
+  : m_size      ( 0, 0 )
+  , m_numBlkCols( 0 )
+  , m_numBlkRows( 0 )
+{
+}
+
+void MotionField::create( const Size& size )
+{
+  m_size       = size;
+  m_numBlkCols = size.width / BLOCK_SIZE;
+  m_numBlkRows = ( size.height + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+
+  m_mvs .assign( 2 * m_numBlkCols * m_numBlkRows, 0 );
+  m_sads.assign( m_numBlkCols * m_numBlkRows, 0 );
+}
+
+void MotionField::destroy()
+{
+  m_size       = Size( 0, 0 );
+  m_numBlkCols = 0;
+  m_numBlkRows = 0;
+
+  std::vector<int16_t>().swap( m_mvs );
+  std::vector<uint16_t>().swap( m_sads );
+}
+
+void MotionField::clear()
+{
+  std::fill( m_mvs .begin(), m_mvs .end(), 0 );
+  std::fill( m_sads.begin(), m_sads.end(), 0 );
+}
+
+void MotionFieldPool::create( const Size& size, const int numFields )
+{
+  destroy();
+
+  for( int i = 0; i < numFields; i++ )
+  {
+    m_fields.push_back( std::unique_ptr<MotionField>( new MotionField ) );
+    m_fields.back()->create( size );
+    m_free.push_back( m_fields.back().get() );
+  }
+}
+
+void MotionFieldPool::destroy()
+{
+  m_free.clear();
+  m_fields.clear();
+}
+
+MotionField* MotionFieldPool::acquire( const Size& size )
+{
+  if( m_free.empty() )
+  {
+    m_fields.push_back( std::unique_ptr<MotionField>( new MotionField ) );
+    m_free.push_back( m_fields.back().get() );
+  }
+
+  MotionField* field = m_free.back();
+  m_free.pop_back();
+
+  if( field->getSize() != size )
+  {
+    field->create( size );
+  }
+  else
+  {
+    field->clear();
+  }
+
+  return field;
+}
+
+void MotionFieldPool::release( MotionField* field )
+{
+  if( field != nullptr )
+  {
+    CHECKD( std::find( m_free.begin(), m_free.end(), field ) != m_free.end(), "Motion field released twice" );
+    m_free.push_back( field );
+  }
+}
+
+//! \}
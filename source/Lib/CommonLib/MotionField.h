@@ -0,0 +1,109 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     MotionField.h
+ *  \brief    Compact per-4x4 motion field of the original luma used by the DT partitioning features
+ */
+
+#ifndef __MOTIONFIELD__
+#define __MOTIONFIELD__
+
+#include "CommonDef.h"
+#include "Common.h"
+#include "Mv.h"
+
+#include <memory>
+#include <vector>
+
+//! \ingroup CommonLib
+//! \{
+
+/// one MV and the SAD of its position per 4x4 luma block, both components of the MV and the SAD take 16 bits
+/// MVs are in units of the distance to the reference picture, SADs saturate at 65535
+class MotionField
+{
+public:
+  static const int BLOCK_SIZE = 4;
+
+  MotionField();
+
+  void     create       ( const Size& size );
+  void     destroy      ();
+  void     clear        ();
+
+  const Size& getSize   ()                                      const { return m_size;       }
+  int      getNumBlkCols()                                      const { return m_numBlkCols; }
+  int      getNumBlkRows()                                      const { return m_numBlkRows; }
+
+  /// blocks are addressed in raster order, blkIdx = blkY * getNumBlkCols() + blkX
+  Mv       getMv        ( const int blkIdx )                    const { return Mv( m_mvs[2 * blkIdx], m_mvs[2 * blkIdx + 1] ); }
+  int      getSAD       ( const int blkIdx )                    const { return m_sads[blkIdx]; }
+  Mv       getMv        ( const int blkX, const int blkY )      const { return getMv ( blkY * m_numBlkCols + blkX ); }
+  int      getSAD       ( const int blkX, const int blkY )      const { return getSAD( blkY * m_numBlkCols + blkX ); }
+
+  void     setMv        ( const int blkIdx, const Mv& mv )
+  {
+    m_mvs[2 * blkIdx]     = ( int16_t ) Clip3<int>( INT16_MIN, INT16_MAX, mv.getHor() );
+    m_mvs[2 * blkIdx + 1] = ( int16_t ) Clip3<int>( INT16_MIN, INT16_MAX, mv.getVer() );
+  }
+  void     setSAD       ( const int blkIdx, const int sad )     { m_sads[blkIdx] = ( uint16_t ) Clip3<int>( 0, UINT16_MAX, sad ); }
+
+private:
+  Size                  m_size;
+  int                   m_numBlkCols;
+  int                   m_numBlkRows;
+
+  std::vector<int16_t>  m_mvs;
+  std::vector<uint16_t> m_sads;
+};
+
+/// ring of motion fields for the pictures in flight, a picture holds a field from the start of its
+/// motion search until it is coded and the field is handed to the next picture
+class MotionFieldPool
+{
+public:
+  void          create ( const Size& size, const int numFields );
+  void          destroy();
+
+  /// a cleared field of the given size, the ring grows if all fields are in use
+  MotionField*  acquire( const Size& size );
+  void          release( MotionField* field );
+
+private:
+  std::vector<std::unique_ptr<MotionField>> m_fields;
+  std::vector<MotionField*>                 m_free;
+};
+
+//! \}
+
+#endif
@@ -48,6 +48,8 @@
 #include "CodingStructure.h"
 #include "Hash.h"
 #include "MCTS.h"
+#include "FeatureIntegrals.h"
+#include "MotionField.h"
 #include <deque>
 
 #if ENABLE_SPLIT_PARALLELISM
@@ -102,11 +104,6 @@ struct Picture : public UnitArea
   void create( const ChromaFormat &_chromaFormat, const Size &size, const unsigned _maxCUSize, const unsigned margin, const bool bDecoder, const int layerId );
   void destroy();
 
-#if FEATURE_TEST
-  void createMv(const ChromaFormat& _chromaFormat, const Size& size, const unsigned _maxCUSize, const unsigned margin, const bool bDecoder, const int layerId);
-  void destroyMv();
-#endif
-
   void createTempBuffers( const unsigned _maxCUSize );
   void destroyTempBuffers();
 
@@ -134,10 +131,11 @@ struct Picture : public UnitArea
   const CPelUnitBuf getResiBuf(const UnitArea &unit) const;
 
 #if FEATURE_TEST
-		Mv*    getMvArray();
-  const Mv*    getMvArray() const;
-        int* getSADErr();
-  const int* getSADErr() const;
+        MotionField*      getMotionField()       { return motionField; }
+  const MotionField*      getMotionField() const { return motionField; }
+  void                    setMotionField( MotionField* field ) { motionField = field; }
+  const FeatureIntegrals* getFeatureIntegrals() const { return featureIntegrals; }
+  void                    setFeatureIntegrals( const FeatureIntegrals* integrals ) { featureIntegrals = integrals; }
 #endif
 
 
@@ -261,10 +259,10 @@ public:
   PelStorage m_bufs[PARL_SPLIT_MAX_NUM_JOBS][NUM_PIC_TYPES];
 #else
   PelStorage m_bufs[NUM_PIC_TYPES];
-#if FEATURE_TEST
-  Mv* mvArray;
-  int* sadErrArray;
 #endif
+#if FEATURE_TEST
+  const FeatureIntegrals* featureIntegrals;   // integral images of the original luma, only set while the picture is compressed
+  MotionField*            motionField;        // DT motion field, only held from the motion search until the picture is coded
 #endif
   const Picture*           unscaledPic;
 
@@ -64,28 +64,10 @@
 #define FEATURE_TEST									  1
 #define FEATURE_EXTRACTION_DIAMOND						  1
 
-#define COLLECT_DATASET                 0
-
-#if COLLECT_DATASET
-  extern std::string filename_arg;
-  extern int qp_arg;
-#endif
-
 #define MORE_RESTRICTIVE_SKIP							  0
 #define DISABLE_QT_NULL_CU_CHECK						  1
 #define DISABLE_RF_IF_EMPTY_CU_WHEN_FULL				  1
 
-#define RF_TH_CMD                                 1
-
-#if !RF_TH_CMD
-#define INTIALIZE_TO_0_5								  0
-#define INTIALIZE_TO_0_75								  0
-#define INTIALIZE_TO_0_85								  0
-#define INTIALIZE_TO_1_00								  0
-#define INTIALIZE_TO_0_90								  0
-#define INTIALIZE_TO_0_95								  1
-#endif
-
 
 #define JVET_S0058_GCI                                    1 // no_mtt_constraint_flag and no_weightedpred_constraint_flag
 
@@ -351,6 +333,8 @@ typedef std::pair<int, int>  TrCost;
 #define ENABLE_SIMD_OPT_DIST                            ( 1 && ENABLE_SIMD_OPT )                            ///< SIMD optimization for the distortion calculations(SAD,SSE,HADAMARD), no impact on RD performance
 #define ENABLE_SIMD_OPT_AFFINE_ME                       ( 1 && ENABLE_SIMD_OPT )                            ///< SIMD optimization for affine ME, no impact on RD performance
 #define ENABLE_SIMD_OPT_ALF                             ( 1 && ENABLE_SIMD_OPT )                            ///< SIMD optimization for ALF
+#define ENABLE_SIMD_OPT_DT_FOREST                       ( 1 && ENABLE_SIMD_OPT )                            ///< SIMD optimization for the DT forest traversal, no impact on RD performance
+#define ENABLE_SIMD_OPT_FEATURES                        ( 1 && ENABLE_SIMD_OPT )                            ///< SIMD optimization for the DT feature integral images, no impact on RD performance
 #if ENABLE_SIMD_OPT_BUFFER
 #define ENABLE_SIMD_OPT_BCW                               1                                                 ///< SIMD optimization for Bcw
 #endif
@@ -892,6 +876,23 @@ enum CostMode
   COST_MIXED_LOSSLESS_LOSSY_CODING = 3
 };
 
+#if FEATURE_TEST
+enum DTMode
+{
+  DT_MODE_OFF           = 0,   // baseline partition search, no features are extracted
+  DT_MODE_INFER         = 1,   // splits pruned by the decision trees
+  DT_MODE_COLLECT       = 2,   // features and split costs written to the dataset
+  DT_MODE_INFER_COLLECT = 3    // pruned encoding with the dataset collected alongside
+};
+
+enum DTSplitOrder
+{
+  DT_SPLIT_ORDER_OFF       = 0,   // split modes tested in the fixed order
+  DT_SPLIT_ORDER_SORT      = 1,   // split modes tested from the most to the least likely by the DT probabilities
+  DT_SPLIT_ORDER_TERMINATE = 2    // sorted, the remaining split modes skipped once the best cost beats their expected costs
+};
+#endif
+
 enum WeightedPredictionMethod
 {
   WP_PER_PICTURE_WITH_SIMPLE_DC_COMBINED_COMPONENT                          =0,
@@ -1310,6 +1311,8 @@ public:
   void push_back( const T& _val )               { CHECKD( _size >= N, "capacity exceeded" ); _arr[ _size++ ] = _val; }
   void push_back( T&& val )                     { CHECKD( _size >= N, "capacity exceeded" ); _arr[ _size++ ] = std::forward<T>( val ); }
   void pop_back()                               { CHECKD( _size == 0, "calling pop_back on an empty vector" ); _size--; }
+  // grows by the element past the end without assigning it, it keeps the state it had when it was popped
+  reference reuse_back()                        { CHECKD( _size >= N, "capacity exceeded" ); return _arr[ _size++ ]; }
   void pop_front()                              { CHECKD( _size == 0, "calling pop_front on an empty vector" ); _size--; for( int i = 0; i < _size; i++ ) _arr[i] = _arr[i + 1]; }
   void clear()                                  { _size = 0; }
   reference       at( size_t _i )               { CHECKD( _i >= _size, "Trying to access an out-of-bound-element" ); return _arr[ _i ]; }
@@ -0,0 +1,116 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTForestTraversalX86.h
+ *  \brief    SIMD traversal of packed decision forests
+ */
+
+#include "CommonDefX86.h"
+#include "../DTForestTraversal.h"
+
+//! \ingroup CommonLib
+//! \{
+
+#ifdef TARGET_SIMD_X86
+
+#if USE_AVX2
+// walks 8 trees in lockstep, lanes that reached a leaf stop moving
+template<X86_VEXT vext>
+static double simdTraverseForest( const int32_t* feature, const float* threshold, const uint32_t* rightOffset, const uint32_t* treeRoot, const int numTrees, const float* features )
+{
+  const __m256i vone    = _mm256_set1_epi32( 1 );
+  const __m256i vminus1 = _mm256_set1_epi32( -1 );
+
+  double sum = 0.0;
+  int    t   = 0;
+
+  for( ; t + 8 <= numTrees; t += 8 )
+  {
+    __m256i vnode = _mm256_loadu_si256( ( const __m256i* ) &treeRoot[t] );
+
+    while( true )
+    {
+      const __m256i vfeat  = _mm256_i32gather_epi32( feature, vnode, 4 );
+      const __m256i vinner = _mm256_cmpgt_epi32( vfeat, vminus1 );
+
+      if( _mm256_testz_si256( vinner, vinner ) )
+      {
+        break;
+      }
+
+      const __m256  vval   = _mm256_mask_i32gather_ps( _mm256_setzero_ps(), features, _mm256_and_si256( vfeat, vinner ), _mm256_castsi256_ps( vinner ), 4 );
+      const __m256  vthr   = _mm256_i32gather_ps( threshold, vnode, 4 );
+      const __m256i vright = _mm256_i32gather_epi32( ( const int* ) rightOffset, vnode, 4 );
+      const __m256i vleft  = _mm256_castps_si256( _mm256_cmp_ps( vval, vthr, _CMP_LE_OQ ) );
+
+      vnode = _mm256_add_epi32( vnode, _mm256_and_si256( _mm256_blendv_epi8( vright, vone, vleft ), vinner ) );
+    }
+
+    // accumulate in tree order to stay bit-exact with the scalar traversal
+    float leaf[8];
+    _mm256_storeu_ps( leaf, _mm256_i32gather_ps( threshold, vnode, 4 ) );
+
+    for( int i = 0; i < 8; i++ )
+    {
+      sum += leaf[i];
+    }
+  }
+
+  for( ; t < numTrees; t++ )
+  {
+    uint32_t node = treeRoot[t];
+
+    while( feature[node] >= 0 )
+    {
+      node += features[feature[node]] <= threshold[node] ? 1 : rightOffset[node];
+    }
+
+    sum += threshold[node];
+  }
+
+  return sum / numTrees;
+}
+#endif
+
+template <X86_VEXT vext>
+void DTForestTraversal::_initDTForestTraversalX86()
+{
+#if USE_AVX2
+  m_traverseForest = simdTraverseForest<vext>;
+#endif
+}
+
+template void DTForestTraversal::_initDTForestTraversalX86<SIMDX86>();
+
+#endif //#ifdef TARGET_SIMD_X86
+//! \}
@@ -0,0 +1,309 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     FeatureIntegralsX86.h
+ *  \brief    SIMD kernels for the DT feature integral images
+ */
+
+#include "CommonDefX86.h"
+#include "../FeatureIntegrals.h"
+
+//! \ingroup CommonLib
+//! \{
+
+#ifdef TARGET_SIMD_X86
+
+#if ENABLE_SIMD_OPT_FEATURES
+
+// columns whose Sobel window is fully inside the row are vectorized, the first one and the remainder use the scalar terms
+template<X86_VEXT vext>
+static void featureRow_SIMD( const Pel* src, const int srcStride, const int width, const bool hasAbove, const bool hasBelow, uint32_t* sample, uint32_t* sqSample, uint32_t* gradHor, uint32_t* gradVer, uint32_t* sobel )
+{
+  const Pel* above    = src - srcStride;
+  const Pel* below    = src + srcStride;
+  const bool hasSobel = hasAbove && hasBelow;
+
+  auto featureColumn = [&]( const int x )
+  {
+    const int p = src[x];
+
+    sample  [x] = p;
+    sqSample[x] = p * p;
+    gradHor [x] = x < width - 1 ? abs( src[x + 1] - p ) : 0;
+    gradVer [x] = hasBelow ? abs( below[x] - p ) : 0;
+    sobel   [x] = 0;
+
+    if( hasSobel && x > 0 && x < width - 1 )
+    {
+      const int gx = ( below[x - 1] + 2 * below[x]   + below[x + 1] ) - ( above[x - 1] + 2 * above[x]   + above[x + 1] );
+      const int gy = ( above[x + 1] + 2 * src  [x + 1] + below[x + 1] ) - ( above[x - 1] + 2 * src  [x - 1] + below[x - 1] );
+
+      sobel[x] = gx * gx + gy * gy;
+    }
+  };
+
+  featureColumn( 0 );
+
+  int x = 1;
+
+#ifdef USE_AVX2
+  if( vext >= AVX2 )
+  {
+    const __m256i vzero = _mm256_setzero_si256();
+
+    // unpack works per 128-bit lane, the permutes restore the sample order
+    auto store = [&]( uint32_t* dst, const __m256i& lo, const __m256i& hi )
+    {
+      _mm256_storeu_si256( ( __m256i* ) dst,         _mm256_permute2x128_si256( lo, hi, 0x20 ) );
+      _mm256_storeu_si256( ( __m256i* ) ( dst + 8 ), _mm256_permute2x128_si256( lo, hi, 0x31 ) );
+    };
+
+    for( ; x + 16 < width; x += 16 )
+    {
+      const __m256i vcur   = _mm256_loadu_si256( ( const __m256i* ) &src[x] );
+      const __m256i vright = _mm256_loadu_si256( ( const __m256i* ) &src[x + 1] );
+
+      __m256i vlo = _mm256_unpacklo_epi16( vcur, vzero );
+      __m256i vhi = _mm256_unpackhi_epi16( vcur, vzero );
+      store( &sample[x], vlo, vhi );
+      store( &sqSample[x], _mm256_madd_epi16( vlo, vlo ), _mm256_madd_epi16( vhi, vhi ) );
+
+      __m256i vgrad = _mm256_abs_epi16( _mm256_sub_epi16( vright, vcur ) );
+      store( &gradHor[x], _mm256_unpacklo_epi16( vgrad, vzero ), _mm256_unpackhi_epi16( vgrad, vzero ) );
+
+      if( hasBelow )
+      {
+        vgrad = _mm256_abs_epi16( _mm256_sub_epi16( _mm256_loadu_si256( ( const __m256i* ) &below[x] ), vcur ) );
+        store( &gradVer[x], _mm256_unpacklo_epi16( vgrad, vzero ), _mm256_unpackhi_epi16( vgrad, vzero ) );
+      }
+      else
+      {
+        store( &gradVer[x], vzero, vzero );
+      }
+
+      if( hasSobel )
+      {
+        const __m256i vleft   = _mm256_loadu_si256( ( const __m256i* ) &src  [x - 1] );
+        const __m256i vaboveL = _mm256_loadu_si256( ( const __m256i* ) &above[x - 1] );
+        const __m256i vabove  = _mm256_loadu_si256( ( const __m256i* ) &above[x] );
+        const __m256i vaboveR = _mm256_loadu_si256( ( const __m256i* ) &above[x + 1] );
+        const __m256i vbelowL = _mm256_loadu_si256( ( const __m256i* ) &below[x - 1] );
+        const __m256i vbelow  = _mm256_loadu_si256( ( const __m256i* ) &below[x] );
+        const __m256i vbelowR = _mm256_loadu_si256( ( const __m256i* ) &below[x + 1] );
+
+        // at most 4 * 4095 in magnitude for 12 bit samples, fits into 16 bits
+        const __m256i vgx = _mm256_sub_epi16( _mm256_add_epi16( _mm256_add_epi16( vbelowL, vbelowR ), _mm256_slli_epi16( vbelow, 1 ) ),
+                                              _mm256_add_epi16( _mm256_add_epi16( vaboveL, vaboveR ), _mm256_slli_epi16( vabove, 1 ) ) );
+        const __m256i vgy = _mm256_sub_epi16( _mm256_add_epi16( _mm256_add_epi16( vaboveR, vbelowR ), _mm256_slli_epi16( vright, 1 ) ),
+                                              _mm256_add_epi16( _mm256_add_epi16( vaboveL, vbelowL ), _mm256_slli_epi16( vleft, 1 ) ) );
+
+        vlo = _mm256_unpacklo_epi16( vgx, vgy );
+        vhi = _mm256_unpackhi_epi16( vgx, vgy );
+        store( &sobel[x], _mm256_madd_epi16( vlo, vlo ), _mm256_madd_epi16( vhi, vhi ) );
+      }
+      else
+      {
+        store( &sobel[x], vzero, vzero );
+      }
+    }
+  }
+#endif
+
+  const __m128i vzero = _mm_setzero_si128();
+
+  for( ; x + 8 < width; x += 8 )
+  {
+    const __m128i vcur   = _mm_loadu_si128( ( const __m128i* ) &src[x] );
+    const __m128i vright = _mm_loadu_si128( ( const __m128i* ) &src[x + 1] );
+
+    __m128i vlo = _mm_unpacklo_epi16( vcur, vzero );
+    __m128i vhi = _mm_unpackhi_epi16( vcur, vzero );
+    _mm_storeu_si128( ( __m128i* ) &sample[x],       vlo );
+    _mm_storeu_si128( ( __m128i* ) &sample[x + 4],   vhi );
+    _mm_storeu_si128( ( __m128i* ) &sqSample[x],     _mm_madd_epi16( vlo, vlo ) );
+    _mm_storeu_si128( ( __m128i* ) &sqSample[x + 4], _mm_madd_epi16( vhi, vhi ) );
+
+    __m128i vgrad = _mm_abs_epi16( _mm_sub_epi16( vright, vcur ) );
+    _mm_storeu_si128( ( __m128i* ) &gradHor[x],     _mm_unpacklo_epi16( vgrad, vzero ) );
+    _mm_storeu_si128( ( __m128i* ) &gradHor[x + 4], _mm_unpackhi_epi16( vgrad, vzero ) );
+
+    vgrad = hasBelow ? _mm_abs_epi16( _mm_sub_epi16( _mm_loadu_si128( ( const __m128i* ) &below[x] ), vcur ) ) : vzero;
+    _mm_storeu_si128( ( __m128i* ) &gradVer[x],     _mm_unpacklo_epi16( vgrad, vzero ) );
+    _mm_storeu_si128( ( __m128i* ) &gradVer[x + 4], _mm_unpackhi_epi16( vgrad, vzero ) );
+
+    if( hasSobel )
+    {
+      const __m128i vleft   = _mm_loadu_si128( ( const __m128i* ) &src  [x - 1] );
+      const __m128i vaboveL = _mm_loadu_si128( ( const __m128i* ) &above[x - 1] );
+      const __m128i vabove  = _mm_loadu_si128( ( const __m128i* ) &above[x] );
+      const __m128i vaboveR = _mm_loadu_si128( ( const __m128i* ) &above[x + 1] );
+      const __m128i vbelowL = _mm_loadu_si128( ( const __m128i* ) &below[x - 1] );
+      const __m128i vbelow  = _mm_loadu_si128( ( const __m128i* ) &below[x] );
+      const __m128i vbelowR = _mm_loadu_si128( ( const __m128i* ) &below[x + 1] );
+
+      const __m128i vgx = _mm_sub_epi16( _mm_add_epi16( _mm_add_epi16( vbelowL, vbelowR ), _mm_slli_epi16( vbelow, 1 ) ),
+                                         _mm_add_epi16( _mm_add_epi16( vaboveL, vaboveR ), _mm_slli_epi16( vabove, 1 ) ) );
+      const __m128i vgy = _mm_sub_epi16( _mm_add_epi16( _mm_add_epi16( vaboveR, vbelowR ), _mm_slli_epi16( vright, 1 ) ),
+                                         _mm_add_epi16( _mm_add_epi16( vaboveL, vbelowL ), _mm_slli_epi16( vleft, 1 ) ) );
+
+      vlo = _mm_unpacklo_epi16( vgx, vgy );
+      vhi = _mm_unpackhi_epi16( vgx, vgy );
+      _mm_storeu_si128( ( __m128i* ) &sobel[x],     _mm_madd_epi16( vlo, vlo ) );
+      _mm_storeu_si128( ( __m128i* ) &sobel[x + 4], _mm_madd_epi16( vhi, vhi ) );
+    }
+    else
+    {
+      _mm_storeu_si128( ( __m128i* ) &sobel[x],     vzero );
+      _mm_storeu_si128( ( __m128i* ) &sobel[x + 4], vzero );
+    }
+  }
+
+  for( ; x < width; x++ )
+  {
+    featureColumn( x );
+  }
+}
+
+// in-register prefix sums, the running row sum is carried in all lanes of vcarry
+template<X86_VEXT vext>
+static void integrate32_SIMD( const uint32_t* src, const uint32_t* prev, uint32_t* dst, const int width )
+{
+  uint32_t rowSum = 0;
+  int      x      = 0;
+
+#ifdef USE_AVX2
+  if( vext >= AVX2 )
+  {
+    const __m256i vzero  = _mm256_setzero_si256();
+    __m256i       vcarry = vzero;
+
+    for( ; x + 8 <= width; x += 8 )
+    {
+      __m256i v = _mm256_loadu_si256( ( const __m256i* ) &src[x] );
+      v = _mm256_add_epi32( v, _mm256_slli_si256( v, 4 ) );
+      v = _mm256_add_epi32( v, _mm256_slli_si256( v, 8 ) );
+      v = _mm256_add_epi32( v, _mm256_blend_epi32( vzero, _mm256_permutevar8x32_epi32( v, _mm256_set1_epi32( 3 ) ), 0xf0 ) );
+      v = _mm256_add_epi32( v, vcarry );
+      vcarry = _mm256_permutevar8x32_epi32( v, _mm256_set1_epi32( 7 ) );
+      _mm256_storeu_si256( ( __m256i* ) &dst[x], _mm256_add_epi32( v, _mm256_loadu_si256( ( const __m256i* ) &prev[x] ) ) );
+    }
+
+    rowSum = ( uint32_t ) _mm_cvtsi128_si32( _mm256_castsi256_si128( vcarry ) );
+  }
+  else
+#endif
+  {
+    __m128i vcarry = _mm_setzero_si128();
+
+    for( ; x + 4 <= width; x += 4 )
+    {
+      __m128i v = _mm_loadu_si128( ( const __m128i* ) &src[x] );
+      v = _mm_add_epi32( v, _mm_slli_si128( v, 4 ) );
+      v = _mm_add_epi32( v, _mm_slli_si128( v, 8 ) );
+      v = _mm_add_epi32( v, vcarry );
+      vcarry = _mm_shuffle_epi32( v, 0xff );
+      _mm_storeu_si128( ( __m128i* ) &dst[x], _mm_add_epi32( v, _mm_loadu_si128( ( const __m128i* ) &prev[x] ) ) );
+    }
+
+    rowSum = ( uint32_t ) _mm_cvtsi128_si32( vcarry );
+  }
+
+  for( ; x < width; x++ )
+  {
+    rowSum += src[x];
+    dst[x]  = prev[x] + rowSum;
+  }
+}
+
+template<X86_VEXT vext>
+static void integrate64_SIMD( const uint32_t* src, const uint64_t* prev, uint64_t* dst, const int width )
+{
+  uint64_t rowSum = 0;
+  int      x      = 0;
+
+#ifdef USE_AVX2
+  if( vext >= AVX2 )
+  {
+    const __m256i vzero  = _mm256_setzero_si256();
+    __m256i       vcarry = vzero;
+
+    for( ; x + 4 <= width; x += 4 )
+    {
+      __m256i v = _mm256_cvtepu32_epi64( _mm_loadu_si128( ( const __m128i* ) &src[x] ) );
+      v = _mm256_add_epi64( v, _mm256_slli_si256( v, 8 ) );
+      v = _mm256_add_epi64( v, _mm256_blend_epi32( vzero, _mm256_permute4x64_epi64( v, 0x55 ), 0xf0 ) );
+      v = _mm256_add_epi64( v, vcarry );
+      vcarry = _mm256_permute4x64_epi64( v, 0xff );
+      _mm256_storeu_si256( ( __m256i* ) &dst[x], _mm256_add_epi64( v, _mm256_loadu_si256( ( const __m256i* ) &prev[x] ) ) );
+    }
+
+    _mm_storel_epi64( ( __m128i* ) &rowSum, _mm256_castsi256_si128( vcarry ) );
+  }
+  else
+#endif
+  {
+    __m128i vcarry = _mm_setzero_si128();
+
+    for( ; x + 2 <= width; x += 2 )
+    {
+      __m128i v = _mm_cvtepu32_epi64( _mm_loadl_epi64( ( const __m128i* ) &src[x] ) );
+      v = _mm_add_epi64( v, _mm_slli_si128( v, 8 ) );
+      v = _mm_add_epi64( v, vcarry );
+      vcarry = _mm_unpackhi_epi64( v, v );
+      _mm_storeu_si128( ( __m128i* ) &dst[x], _mm_add_epi64( v, _mm_loadu_si128( ( const __m128i* ) &prev[x] ) ) );
+    }
+
+    _mm_storel_epi64( ( __m128i* ) &rowSum, vcarry );
+  }
+
+  for( ; x < width; x++ )
+  {
+    rowSum += src[x];
+    dst[x]  = prev[x] + rowSum;
+  }
+}
+
+template <X86_VEXT vext>
+void FeatureIntegralOps::_initFeatureIntegralOpsX86()
+{
+  featureRow  = featureRow_SIMD<vext>;
+  integrate32 = integrate32_SIMD<vext>;
+  integrate64 = integrate64_SIMD<vext>;
+}
+
+template void FeatureIntegralOps::_initFeatureIntegralOpsX86<SIMDX86>();
+
+#endif
+
+#endif //#ifdef TARGET_SIMD_X86
+//! \}
@@ -50,6 +50,10 @@
 
 #include "CommonLib/IbcHashMap.h"
 
+#include "CommonLib/DTForestTraversal.h"
+
+#include "CommonLib/FeatureIntegrals.h"
+
 #ifdef TARGET_SIMD_X86
 
 
@@ -167,6 +171,45 @@ void AdaptiveLoopFilter::initAdaptiveLoopFilterX86()
 }
 #endif
 
+#if ENABLE_SIMD_OPT_DT_FOREST
+void DTForestTraversal::initDTForestTraversalX86()
+{
+  auto vext = read_x86_extension_flags();
+  switch ( vext )
+  {
+  case AVX512:
+  case AVX2:
+    _initDTForestTraversalX86<AVX2>();
+    break;
+  default:
+    break;
+  }
+}
+#endif
+
+#if ENABLE_SIMD_OPT_FEATURES
+void FeatureIntegralOps::initFeatureIntegralOpsX86()
+{
+  auto vext = read_x86_extension_flags();
+  switch ( vext )
+  {
+  case AVX512:
+  case AVX2:
+    _initFeatureIntegralOpsX86<AVX2>();
+    break;
+  case AVX:
+    _initFeatureIntegralOpsX86<AVX>();
+    break;
+  case SSE42:
+  case SSE41:
+    _initFeatureIntegralOpsX86<SSE41>();
+    break;
+  default:
+    break;
+  }
+}
+#endif
+
 #if ENABLE_SIMD_OPT_IBC
 void IbcHashMap::initIbcHashMapX86()
 {
@@ -0,0 +1,366 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTDataset.cpp
+    \brief    buffered binary writer of the DT training dataset
+*/
+
+#include "DTDataset.h"
+
+#include <algorithm>
+#include <cstring>
+
+//! \ingroup EncoderLib
+//! \{
+
+static_assert( sizeof( DTFeatureRecord ) == 32 + 4 * DT_DATASET_MAX_FEATURES + 4, "DTFeatureRecord must not be padded" );
+static_assert( sizeof( DTCostRecord ) == 40, "DTCostRecord must not be padded" );
+
+// records are handed to the writer thread in chunks of this size
+static const size_t DT_DATASET_CHUNK_SIZE = 1 << 20;
+
+static std::mutex                                             g_dtDatasetMutex;
+static std::map<std::string, std::weak_ptr<DTDatasetWriter> > g_dtDatasetRegistry;
+
+// ====================================================================================================================
+// DTSamplingPolicy
+// ====================================================================================================================
+
+DTSamplingPolicy::DTSamplingPolicy()
+  : m_pocStride  ( 0 )
+  , m_ctuFraction( 1.0 )
+{
+}
+
+void DTSamplingPolicy::init( const int pocStride, const std::vector<int>& pocList, const double ctuFraction )
+{
+  m_pocStride   = std::max( pocStride, 0 );
+  m_pocList     = pocList;
+  m_ctuFraction = ctuFraction;
+
+  std::sort( m_pocList.begin(), m_pocList.end() );
+}
+
+bool DTSamplingPolicy::samplePicture( const int poc, const int lumaHeight ) const
+{
+  if( !m_pocList.empty() )
+  {
+    return std::binary_search( m_pocList.begin(), m_pocList.end(), poc );
+  }
+
+  if( m_pocStride > 0 )
+  {
+    return poc % m_pocStride == 0;
+  }
+
+  // pictures the published dataset was collected on
+  if( lumaHeight == 544 || lumaHeight == 272 )
+  {
+    return poc % 3 == 0;
+  }
+
+  if( lumaHeight == 1088 || lumaHeight == 2176 || lumaHeight == 720 )
+  {
+    return poc == 8 || poc == 16 || poc == 28 || poc == 42 || poc == 49 || poc == 57;
+  }
+
+  return false;
+}
+
+bool DTSamplingPolicy::sampleCtu( const int poc, const unsigned ctuRsAddr ) const
+{
+  if( m_ctuFraction >= 1.0 )
+  {
+    return true;
+  }
+
+  // murmur3 finaliser of the CTU position, uniform in [0, 2^32)
+  uint32_t hash = uint32_t( poc ) * 0x9e3779b1u ^ ctuRsAddr;
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35u;
+  hash ^= hash >> 16;
+
+  return hash < m_ctuFraction * 4294967296.0;
+}
+
+// ====================================================================================================================
+// DTDatasetWriter
+// ====================================================================================================================
+
+std::shared_ptr<DTDatasetWriter> DTDatasetWriter::open( const std::string& name, const int blockCap )
+{
+  std::lock_guard<std::mutex> lock( g_dtDatasetMutex );
+
+  std::shared_ptr<DTDatasetWriter> writer = g_dtDatasetRegistry[name].lock();
+
+  if( !writer )
+  {
+    writer = std::shared_ptr<DTDatasetWriter>( new DTDatasetWriter( name, blockCap ) );
+    g_dtDatasetRegistry[name] = writer;
+  }
+
+  return writer;
+}
+
+DTDatasetWriter::DTDatasetWriter( const std::string& name, const int blockCap )
+  : m_name     ( name )
+  , m_stop     ( false )
+  , m_failed   ( false )
+  , m_blockCap ( blockCap )
+  , m_poc      ( 0 )
+  , m_numBlocks( 0 )
+{
+  const char*    prefix[NUM_STREAMS] = { "split_features_", "split_cost_" };
+  const uint32_t magic [NUM_STREAMS] = { DT_DATASET_FEATURE_MAGIC, DT_DATASET_COST_MAGIC };
+  const uint32_t size  [NUM_STREAMS] = { sizeof( DTFeatureRecord ), sizeof( DTCostRecord ) };
+
+  for( int s = 0; s < NUM_STREAMS; s++ )
+  {
+    const std::string fileName = prefix[s] + name + ".bin";
+
+    m_files[s] = fopen( fileName.c_str(), "wb" );
+    CHECK( m_files[s] == nullptr, "Cannot open DT dataset file " << fileName );
+
+    const DTDatasetFileHeader header = { magic[s], DT_DATASET_VERSION, size[s], DT_DATASET_MAX_FEATURES };
+    CHECK( fwrite( &header, sizeof( header ), 1, m_files[s] ) != 1, "Cannot write DT dataset file " << fileName );
+
+    m_buffers[s].reserve( DT_DATASET_CHUNK_SIZE );
+  }
+
+  m_thread = std::thread( &DTDatasetWriter::xWriterThread, this );
+}
+
+DTDatasetWriter::~DTDatasetWriter()
+{
+  {
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    xFlushPicture();
+
+    for( int s = 0; s < NUM_STREAMS; s++ )
+    {
+      if( !m_buffers[s].empty() )
+      {
+        m_pending.emplace_back( Stream( s ), std::move( m_buffers[s] ) );
+      }
+    }
+    m_stop = true;
+  }
+  m_cond.notify_one();
+  m_thread.join();
+
+  // destructors cannot throw, a truncated dataset is reported instead
+  bool failed = m_failed;
+
+  for( int s = 0; s < NUM_STREAMS; s++ )
+  {
+    failed |= fclose( m_files[s] ) != 0;
+  }
+
+  if( failed )
+  {
+    msg( ERROR, "Error: DT dataset %s could not be written completely\n", m_name.c_str() );
+  }
+}
+
+void DTDatasetWriter::writeFeatures( const DTDecision decision, const int poc, const Area& area, const SplitSeries splitSeries, const float* features )
+{
+  DTFeatureRecord record;
+  memset( &record, 0, sizeof( record ) );
+
+  record.poc         = poc;
+  record.width       = area.width;
+  record.height      = area.height;
+  record.x           = area.x;
+  record.y           = area.y;
+  record.splitSeries = splitSeries;
+  record.decision    = decision;
+  record.numFeatures = DT_NUM_FEATURES[decision];
+  memcpy( record.features, features, DT_NUM_FEATURES[decision] * sizeof( float ) );
+
+  xSubmit( STREAM_FEATURES, poc, BlockKey( area.x, area.y, area.width, area.height, splitSeries ), &record, sizeof( record ) );
+}
+
+void DTDatasetWriter::writeCost( const int poc, const Area& area, const SplitSeries splitSeries, const int splitType, const double cost, const uint32_t toolFlags )
+{
+  DTCostRecord record;
+  memset( &record, 0, sizeof( record ) );
+
+  record.poc         = poc;
+  record.width       = area.width;
+  record.height      = area.height;
+  record.x           = area.x;
+  record.y           = area.y;
+  record.splitSeries = splitSeries;
+  record.splitType   = splitType;
+  record.toolFlags   = toolFlags;
+  record.cost        = cost;
+
+  xSubmit( STREAM_COST, poc, BlockKey( area.x, area.y, area.width, area.height, splitSeries ), &record, sizeof( record ) );
+}
+
+void DTDatasetWriter::xSubmit( const Stream stream, const int poc, const BlockKey& key, const void* record, const size_t size )
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  CHECK( m_failed, "Cannot write DT dataset " << m_name );
+
+  if( m_blockCap <= 0 )
+  {
+    xAppend( stream, record, size );
+    return;
+  }
+
+  if( poc != m_poc )
+  {
+    xFlushPicture();
+    m_poc = poc;
+  }
+
+  auto block = m_blocks.find( key );
+
+  if( block == m_blocks.end() )
+  {
+    // Algorithm R: the n-th block of a size replaces a random kept one with probability blockCap / n
+    block = m_blocks.emplace( key, SampledBlock() ).first;
+    block->second.order = m_numBlocks++;
+    block->second.kept  = true;
+
+    Reservoir& reservoir = m_reservoirs[std::make_pair( std::get<2>( key ), std::get<3>( key ) )];
+    reservoir.numSeen++;
+
+    if( ( int ) reservoir.kept.size() < m_blockCap )
+    {
+      reservoir.kept.push_back( &block->first );
+    }
+    else
+    {
+      const uint64_t slot = std::uniform_int_distribution<uint64_t>( 0, reservoir.numSeen - 1 )( m_random );
+
+      if( slot < ( uint64_t ) m_blockCap )
+      {
+        SampledBlock& evicted = m_blocks[*reservoir.kept[slot]];
+        evicted.kept = false;
+        for( int s = 0; s < NUM_STREAMS; s++ )
+        {
+          std::vector<uint8_t>().swap( evicted.records[s] );
+        }
+        reservoir.kept[slot] = &block->first;
+      }
+      else
+      {
+        block->second.kept = false;
+      }
+    }
+  }
+
+  if( block->second.kept )
+  {
+    const uint8_t* bytes = static_cast<const uint8_t*>( record );
+    block->second.records[stream].insert( block->second.records[stream].end(), bytes, bytes + size );
+  }
+}
+
+void DTDatasetWriter::xFlushPicture()
+{
+  std::vector<const SampledBlock*> kept;
+
+  for( const auto& block : m_blocks )
+  {
+    if( block.second.kept )
+    {
+      kept.push_back( &block.second );
+    }
+  }
+
+  std::sort( kept.begin(), kept.end(), []( const SampledBlock* a, const SampledBlock* b ) { return a->order < b->order; } );
+
+  for( const SampledBlock* block : kept )
+  {
+    for( int s = 0; s < NUM_STREAMS; s++ )
+    {
+      if( !block->records[s].empty() )
+      {
+        xAppend( Stream( s ), block->records[s].data(), block->records[s].size() );
+      }
+    }
+  }
+
+  m_blocks.clear();
+  m_reservoirs.clear();
+  m_numBlocks = 0;
+}
+
+void DTDatasetWriter::xAppend( const Stream stream, const void* record, const size_t size )
+{
+  std::vector<uint8_t>& buffer = m_buffers[stream];
+  const uint8_t*        bytes  = static_cast<const uint8_t*>( record );
+
+  buffer.insert( buffer.end(), bytes, bytes + size );
+
+  if( buffer.size() >= DT_DATASET_CHUNK_SIZE )
+  {
+    m_pending.emplace_back( stream, std::move( buffer ) );
+    buffer = std::vector<uint8_t>();
+    buffer.reserve( DT_DATASET_CHUNK_SIZE );
+
+    m_cond.notify_one();
+  }
+}
+
+void DTDatasetWriter::xWriterThread()
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+
+  while( true )
+  {
+    m_cond.wait( lock, [this]() { return m_stop || !m_pending.empty(); } );
+
+    if( m_pending.empty() )
+    {
+      return;
+    }
+
+    std::pair<Stream, std::vector<uint8_t> > chunk = std::move( m_pending.front() );
+    m_pending.pop_front();
+    lock.unlock();
+
+    const size_t written = fwrite( chunk.second.data(), 1, chunk.second.size(), m_files[chunk.first] );
+
+    lock.lock();
+    m_failed |= written != chunk.second.size();
+  }
+}
+
+//! \}
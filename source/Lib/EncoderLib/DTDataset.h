@@ -0,0 +1,210 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTDataset.h
+    \brief    buffered binary writer of the DT training dataset (header)
+*/
+
+#ifndef __DTDATASET__
+#define __DTDATASET__
+
+#include "CommonLib/CommonDef.h"
+#include "CommonLib/Common.h"
+#include "DTForest.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// File format
+// ====================================================================================================================
+
+// A dataset is written as two files, split_features_<name>.bin and split_cost_<name>.bin. Each starts with a
+// DTDatasetFileHeader followed by fixed-size little endian records, so a file can be read in one go as an array of
+// structs (e.g. a numpy structured dtype) and every field accessed as a column.
+//
+//   features: DTFeatureRecord[], one per DT decision of a CU, unused trailing features are zero
+//   costs:    DTCostRecord[], one per tested BT, TT or QT split, and one for the best non-split mode of each CU
+//
+// Both tables are keyed by (poc, x, y, width, height, splitSeries) to join the features with the split costs.
+
+static const uint32_t DT_DATASET_FEATURE_MAGIC = 0x46534456; // "VDSF"
+static const uint32_t DT_DATASET_COST_MAGIC    = 0x43534456; // "VDSC"
+static const uint32_t DT_DATASET_VERSION       = 1;
+static const int      DT_DATASET_MAX_FEATURES  = 45;
+
+/// labels of the inter tool decisions, set in DTCostRecord::toolFlags
+enum DTToolFlags
+{
+  DT_TOOL_AFFINE = 1 << 0,   ///< subblock (affine or SbTMVP) merge, the ETM_AFFINE mode
+  DT_TOOL_GEO    = 1 << 1,
+  DT_TOOL_CIIP   = 1 << 2,
+  DT_TOOL_MMVD   = 1 << 3,
+};
+
+struct DTDatasetFileHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t recordSize;
+  uint32_t maxFeatures;
+};
+
+struct DTFeatureRecord
+{
+  int32_t  poc;
+  uint16_t width;
+  uint16_t height;
+  int32_t  x;
+  int32_t  y;
+  uint64_t splitSeries;
+  uint32_t decision;          ///< DTDecision
+  uint32_t numFeatures;
+  float    features[DT_DATASET_MAX_FEATURES];
+  uint32_t reserved;          ///< pads the record to a multiple of 8 bytes
+};
+
+struct DTCostRecord
+{
+  int32_t  poc;
+  uint16_t width;
+  uint16_t height;
+  int32_t  x;
+  int32_t  y;
+  uint64_t splitSeries;
+  uint32_t splitType;         ///< EncTestModeType of the split, ETM_POST_DONT_SPLIT for the best non-split mode
+  uint32_t toolFlags;         ///< best non-split mode only: DTToolFlags of the inter tools it uses
+  double   cost;
+};
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// pictures and CTUs contributing to the dataset, decided once per picture and CTU
+class DTSamplingPolicy
+{
+public:
+  DTSamplingPolicy();
+
+  /// an explicit POC list takes precedence over the POC stride, a stride of 0 selects the pictures of the published
+  /// dataset by picture height
+  void init         ( const int pocStride, const std::vector<int>& pocList, const double ctuFraction );
+
+  bool samplePicture( const int poc, const int lumaHeight ) const;
+  /// pseudo-random but reproducible, about ctuFraction of the CTUs of a picture are sampled
+  bool sampleCtu    ( const int poc, const unsigned ctuRsAddr ) const;
+
+private:
+  int              m_pocStride;
+  std::vector<int> m_pocList;
+  double           m_ctuFraction;
+};
+
+/// dataset files of one encoder instance, shared by its mode controllers; records are collected in memory and
+/// written by a background thread, the files are completed when the last user releases the writer
+/// with a block cap, at most blockCap blocks of each size are kept per picture, chosen by reservoir sampling over the
+/// blocks in coding order; all records of a kept block are written when the next picture starts
+class DTDatasetWriter
+{
+public:
+  static std::shared_ptr<DTDatasetWriter> open( const std::string& name, const int blockCap );
+
+  ~DTDatasetWriter();
+
+  void writeFeatures( const DTDecision decision, const int poc, const Area& area, const SplitSeries splitSeries, const float* features );
+  void writeCost    ( const int poc, const Area& area, const SplitSeries splitSeries, const int splitType, const double cost, const uint32_t toolFlags = 0 );
+
+private:
+  enum Stream
+  {
+    STREAM_FEATURES = 0,
+    STREAM_COST     = 1,
+    NUM_STREAMS
+  };
+
+  typedef std::tuple<int, int, int, int, SplitSeries> BlockKey;   ///< x, y, width, height, split series
+
+  struct SampledBlock
+  {
+    uint64_t             order;                 ///< first record of the block in coding order
+    bool                 kept;
+    std::vector<uint8_t> records[NUM_STREAMS];
+  };
+
+  struct Reservoir
+  {
+    uint64_t                        numSeen;
+    std::vector<const BlockKey*>    kept;
+  };
+
+  DTDatasetWriter( const std::string& name, const int blockCap );
+
+  void xSubmit       ( const Stream stream, const int poc, const BlockKey& key, const void* record, const size_t size );
+  void xAppend       ( const Stream stream, const void* record, const size_t size );
+  void xFlushPicture ();
+  void xWriterThread ();
+
+  std::string                                       m_name;
+  FILE*                                             m_files  [NUM_STREAMS];
+  std::vector<uint8_t>                              m_buffers[NUM_STREAMS];
+  std::deque<std::pair<Stream, std::vector<uint8_t> > > m_pending;
+
+  std::mutex                                        m_mutex;
+  std::condition_variable                           m_cond;
+  std::thread                                       m_thread;
+  bool                                              m_stop;
+  bool                                              m_failed;   ///< set by the writer thread, reported to the encoder
+
+  int                                               m_blockCap;
+  int                                               m_poc;
+  uint64_t                                          m_numBlocks;
+  std::map<BlockKey, SampledBlock>                  m_blocks;
+  std::map<std::pair<int, int>, Reservoir>          m_reservoirs;
+  std::mt19937                                      m_random;
+};
+
+//! \}
+
+#endif // __DTDATASET__
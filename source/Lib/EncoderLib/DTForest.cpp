@@ -0,0 +1,346 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTForest.cpp
+    \brief    runtime-loadable random forest models for the DT partition decisions
+*/
+
+#include "DTForest.h"
+
+#include <map>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// DTForest
+// ====================================================================================================================
+
+static std::mutex                                      g_dtForestMutex;
+static std::map<std::string, std::weak_ptr<DTForest> > g_dtForestRegistry;
+
+std::shared_ptr<const DTForest> DTForest::open( const std::string& fileName )
+{
+  std::lock_guard<std::mutex> lock( g_dtForestMutex );
+
+  std::shared_ptr<DTForest> forest = g_dtForestRegistry[fileName].lock();
+
+  if( !forest )
+  {
+    forest = std::shared_ptr<DTForest>( new DTForest( fileName ) );
+    g_dtForestRegistry[fileName] = forest;
+  }
+
+  return forest;
+}
+
+DTForest::DTForest( const std::string& fileName )
+  : m_fileName  ( fileName )
+  , m_data      ( nullptr )
+  , m_size      ( 0 )
+#ifdef _WIN32
+  , m_fileHandle( INVALID_HANDLE_VALUE )
+  , m_mapHandle ( nullptr )
+#endif
+{
+  for( int d = 0; d < NUM_DT_DECISIONS; d++ )
+  {
+    for( int w = 0; w <= MAX_CU_DEPTH; w++ )
+    {
+      for( int h = 0; h <= MAX_CU_DEPTH; h++ )
+      {
+        m_lookup[d][w][h] = -1;
+      }
+    }
+  }
+
+  xMap();
+
+  try
+  {
+    xParse();
+    m_engine.init( *this );
+  }
+  catch( ... )
+  {
+    xUnmap();
+    throw;
+  }
+}
+
+DTForest::~DTForest()
+{
+  xUnmap();
+}
+
+const DTForestModel* DTForest::getModel( const DTDecision decision, const int width, const int height ) const
+{
+  if( width <= 0 || height <= 0 || width > MAX_CU_SIZE || height > MAX_CU_SIZE )
+  {
+    return nullptr;
+  }
+
+  const int idx = m_lookup[decision][floorLog2( width )][floorLog2( height )];
+
+  return idx < 0 ? nullptr : &m_models[idx];
+}
+
+void DTForest::xMap()
+{
+#ifdef _WIN32
+  m_fileHandle = CreateFileA( m_fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  CHECK( m_fileHandle == INVALID_HANDLE_VALUE, "Cannot open DT forest file " << m_fileName );
+
+  LARGE_INTEGER fileSize;
+  GetFileSizeEx( m_fileHandle, &fileSize );
+  m_size = size_t( fileSize.QuadPart );
+
+  m_mapHandle = m_size ? CreateFileMappingA( m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr ) : nullptr;
+  m_data      = m_mapHandle ? (const uint8_t*) MapViewOfFile( m_mapHandle, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+  if( !m_data )
+  {
+    xUnmap();
+    THROW( "Cannot map DT forest file " << m_fileName );
+  }
+#else
+  const int fd = ::open( m_fileName.c_str(), O_RDONLY );
+  CHECK( fd < 0, "Cannot open DT forest file " << m_fileName );
+
+  struct stat st;
+  if( fstat( fd, &st ) != 0 || st.st_size == 0 )
+  {
+    ::close( fd );
+    THROW( "Cannot map DT forest file " << m_fileName );
+  }
+  m_size = size_t( st.st_size );
+
+  void* data = mmap( nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0 );
+  ::close( fd );
+  CHECK( data == MAP_FAILED, "Cannot map DT forest file " << m_fileName );
+
+  m_data = (const uint8_t*) data;
+#endif
+}
+
+void DTForest::xUnmap()
+{
+#ifdef _WIN32
+  if( m_data )
+  {
+    UnmapViewOfFile( m_data );
+  }
+  if( m_mapHandle )
+  {
+    CloseHandle( m_mapHandle );
+  }
+  if( m_fileHandle != INVALID_HANDLE_VALUE )
+  {
+    CloseHandle( m_fileHandle );
+  }
+  m_mapHandle  = nullptr;
+  m_fileHandle = INVALID_HANDLE_VALUE;
+#else
+  if( m_data )
+  {
+    munmap( (void*) m_data, m_size );
+  }
+#endif
+  m_data = nullptr;
+  m_size = 0;
+}
+
+void DTForest::xParse()
+{
+  CHECK( m_size < sizeof( DTForestFileHeader ), "DT forest file " << m_fileName << " is truncated" );
+
+  const DTForestFileHeader& header = *(const DTForestFileHeader*) m_data;
+  CHECK( header.magic   != DT_FOREST_MAGIC,   "DT forest file " << m_fileName << " has a wrong magic number" );
+  CHECK( header.version != DT_FOREST_VERSION, "DT forest file " << m_fileName << " has unsupported version " << header.version );
+  CHECK( m_size < sizeof( DTForestFileHeader ) + uint64_t( header.numModels ) * sizeof( DTForestModelEntry ), "DT forest file " << m_fileName << " is truncated" );
+
+  const DTForestModelEntry* entries = (const DTForestModelEntry*) ( m_data + sizeof( DTForestFileHeader ) );
+
+  auto array = [&]( const uint64_t offset, const uint32_t num ) -> const uint8_t*
+  {
+    CHECK( offset & 3, "DT forest file " << m_fileName << " contains an unaligned array" );
+    CHECK( offset > m_size || uint64_t( num ) * 4 > m_size - offset, "DT forest file " << m_fileName << " is truncated" );
+    return m_data + offset;
+  };
+
+  m_models.resize( header.numModels );
+
+  for( uint32_t i = 0; i < header.numModels; i++ )
+  {
+    const DTForestModelEntry& entry = entries[i];
+    DTForestModel&            model = m_models[i];
+
+    CHECK( entry.decision >= NUM_DT_DECISIONS, "DT forest file " << m_fileName << ": unknown decision " << entry.decision );
+    CHECK( entry.width  < 4 || entry.width  > MAX_CU_SIZE || ( entry.width  & ( entry.width  - 1 ) ), "DT forest file " << m_fileName << ": invalid block width "  << entry.width );
+    CHECK( entry.height < 4 || entry.height > MAX_CU_SIZE || ( entry.height & ( entry.height - 1 ) ), "DT forest file " << m_fileName << ": invalid block height " << entry.height );
+    CHECK( entry.numFeatures != DT_NUM_FEATURES[entry.decision], "DT forest file " << m_fileName << ": model " << entry.width << "x" << entry.height << " expects " << entry.numFeatures << " features" );
+    CHECK( entry.numTrees == 0 || entry.numNodes == 0, "DT forest file " << m_fileName << ": empty model " << entry.width << "x" << entry.height );
+
+    model.decision    = DTDecision( entry.decision );
+    model.width       = entry.width;
+    model.height      = entry.height;
+    model.numFeatures = entry.numFeatures;
+    model.numTrees    = entry.numTrees;
+    model.numNodes    = entry.numNodes;
+    model.treeRoot    = (const uint32_t*) array( entry.treeRootOffset,    entry.numTrees );
+    model.feature     = (const int32_t*)  array( entry.featureOffset,     entry.numNodes );
+    model.threshold   = (const float*)    array( entry.thresholdOffset,   entry.numNodes );
+    model.rightOffset = (const uint32_t*) array( entry.rightOffsetOffset, entry.numNodes );
+
+    // validate the node graph once, so that the traversal does not need any bounds checks; children follow their
+    // parent, hence every walk ends in a leaf
+    for( int t = 0; t < model.numTrees; t++ )
+    {
+      CHECK( model.treeRoot[t] >= uint32_t( model.numNodes ), "DT forest file " << m_fileName << ": invalid tree root" );
+    }
+    for( int n = 0; n < model.numNodes; n++ )
+    {
+      if( model.feature[n] >= 0 )
+      {
+        CHECK( model.feature[n] >= model.numFeatures, "DT forest file " << m_fileName << ": invalid feature index" );
+        CHECK( n + 1 >= model.numNodes || model.rightOffset[n] < 2 || model.rightOffset[n] >= uint32_t( model.numNodes - n ), "DT forest file " << m_fileName << ": invalid child node" );
+      }
+    }
+
+    int& idx = m_lookup[entry.decision][floorLog2( entry.width )][floorLog2( entry.height )];
+    CHECK( idx >= 0, "DT forest file " << m_fileName << ": duplicate model " << entry.width << "x" << entry.height );
+    idx = i;
+  }
+}
+
+// ====================================================================================================================
+// DTForestEngine
+// ====================================================================================================================
+
+DTForestEngine::DTForestEngine()
+{
+  destroy();
+}
+
+void DTForestEngine::destroy()
+{
+  m_numModels = 0;
+
+  for( int d = 0; d < NUM_DT_DECISIONS; d++ )
+  {
+    for( int w = 0; w <= MAX_CU_DEPTH; w++ )
+    {
+      for( int h = 0; h <= MAX_CU_DEPTH; h++ )
+      {
+        m_lookup[d][w][h] = nullptr;
+      }
+    }
+  }
+}
+
+void DTForestEngine::init( const DTForest& forest )
+{
+  destroy();
+
+  for( int d = 0; d < NUM_DT_DECISIONS; d++ )
+  {
+    for( int w = 0; w <= MAX_CU_DEPTH; w++ )
+    {
+      for( int h = 0; h <= MAX_CU_DEPTH; h++ )
+      {
+        m_lookup[d][w][h] = forest.getModel( DTDecision( d ), 1 << w, 1 << h );
+        m_numModels      += m_lookup[d][w][h] ? 1 : 0;
+      }
+    }
+  }
+}
+
+double DTForestEngine::predict( const DTDecision decision, const int width, const int height, const float* features ) const
+{
+  if( width <= 0 || height <= 0 || width > MAX_CU_SIZE || height > MAX_CU_SIZE )
+  {
+    return 0.5;
+  }
+
+  const DTForestModel* model = m_lookup[decision][floorLog2( width )][floorLog2( height )];
+
+  if( !model )
+  {
+    return 0.5;
+  }
+
+  return m_traversal.m_traverseForest( model->feature, model->threshold, model->rightOffset, model->treeRoot, model->numTrees, features );
+}
+
+// ====================================================================================================================
+// DTForestBenchmark
+// ====================================================================================================================
+
+void DTForestBenchmark::reset()
+{
+  for( int d = 0; d < NUM_DT_DECISIONS; d++ )
+  {
+    numCalls    [d] = 0;
+    engineTime  [d] = 0.0;
+    compiledTime[d] = 0.0;
+    maxAbsDiff  [d] = 0.0;
+  }
+}
+
+void DTForestBenchmark::print() const
+{
+  const char* name[NUM_DT_DECISIONS] = { "QT/MTT ", "Hor/Ver", "BT/TT  ", "I split", "I QT/MTT", "I Hor/Ver", "Affine ", "GEO    ", "CIIP   ", "MMVD   " };
+
+  msg( INFO, "\nDT forest benchmark   calls      engine [ns/call]  compiled [ns/call]  speed-up  max |diff|\n" );
+
+  for( int d = 0; d < NUM_DT_DECISIONS; d++ )
+  {
+    if( numCalls[d] )
+    {
+      msg( INFO, "  %s          %10llu  %16.1f  %18.1f  %8.2f  %10.3g\n", name[d], (unsigned long long) numCalls[d],
+           1e9 * engineTime[d] / numCalls[d], 1e9 * compiledTime[d] / numCalls[d],
+           engineTime[d] > 0.0 ? compiledTime[d] / engineTime[d] : 0.0, maxAbsDiff[d] );
+    }
+  }
+}
+
+//! \}
@@ -0,0 +1,198 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTForest.h
+    \brief    runtime-loadable random forest models for the DT partition decisions (header)
+*/
+
+#ifndef __DTFOREST__
+#define __DTFOREST__
+
+#include "CommonLib/CommonDef.h"
+#include "CommonLib/DTForestTraversal.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// File format
+// ====================================================================================================================
+
+// A forest file holds one pruned forest per (decision, block size). All fields are little endian, all arrays are
+// 4-byte aligned so the nodes are traversed in place from a read-only mapping of the file.
+//
+//   DTForestFileHeader
+//   DTForestModelEntry[numModels]
+//   per model: uint32_t treeRoot[numTrees], int32_t feature[numNodes], float threshold[numNodes],
+//              uint32_t rightOffset[numNodes]
+//
+// The nodes of each tree are stored in pre-order, so the left child of an inner node is the next node and rightOffset
+// is the distance to its right child. Inner nodes branch to left if features[feature] <= threshold (as sklearn does),
+// leaves have feature < 0 and store the probability of class 1 (MTT for QT/MTT, vertical for Hor/Ver, TT for BT/TT,
+// split for the intra split decision, tool used for the inter tool decisions) in threshold.
+// Tree roots index the node arrays of their model. The forest output is the mean over the trees.
+
+static const uint32_t DT_FOREST_MAGIC   = 0x46544456; // "VDTF"
+static const uint32_t DT_FOREST_VERSION = 2;
+
+enum DTDecision
+{
+  DT_DECISION_QT_MTT  = 0,
+  DT_DECISION_HOR_VER = 1,
+  DT_DECISION_BT_TT   = 2,   ///< binary or ternary split in a given direction, the direction is a feature
+  DT_DECISION_INTRA_SPLIT   = 3,   ///< intra slices: early termination of the split search
+  DT_DECISION_INTRA_QT_MTT  = 4,
+  DT_DECISION_INTRA_HOR_VER = 5,
+  DT_DECISION_AFFINE        = 6,   ///< inter tools: is the tool used by the best non-split CU, on the Hor/Ver features
+  DT_DECISION_GEO           = 7,
+  DT_DECISION_CIIP          = 8,
+  DT_DECISION_MMVD          = 9,
+  NUM_DT_DECISIONS
+};
+
+static const int DT_NUM_FEATURES[NUM_DT_DECISIONS] = { 34, 45, 22, 30, 30, 30, 45, 45, 45, 45 };
+
+struct DTForestFileHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t numModels;
+  uint32_t reserved;
+};
+
+struct DTForestModelEntry
+{
+  uint32_t decision;
+  uint32_t width;
+  uint32_t height;
+  uint32_t numFeatures;
+  uint32_t numTrees;
+  uint32_t numNodes;
+  uint64_t treeRootOffset;    ///< byte offsets from the start of the file
+  uint64_t featureOffset;
+  uint64_t thresholdOffset;
+  uint64_t rightOffsetOffset;
+};
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+struct DTForestModel
+{
+  DTDecision     decision;
+  int            width;
+  int            height;
+  int            numFeatures;
+  int            numTrees;
+  int            numNodes;
+  const uint32_t* treeRoot;
+  const int32_t*  feature;
+  const float*    threshold;
+  const uint32_t* rightOffset;
+};
+
+class DTForest;
+
+/// inference on the packed models of a forest, the nodes are read in place from the mapped file
+class DTForestEngine
+{
+public:
+  DTForestEngine();
+
+  void   init         ( const DTForest& forest );
+  void   destroy      ();
+  bool   isInitialized() const { return m_numModels > 0; }
+
+  /// probability of class 1, 0.5 if there is no model for the block size
+  double predict      ( const DTDecision decision, const int width, const int height, const float* features ) const;
+
+private:
+  int                      m_numModels;
+  const DTForestModel*     m_lookup[NUM_DT_DECISIONS][MAX_CU_DEPTH + 1][MAX_CU_DEPTH + 1];
+  DTForestTraversal        m_traversal;
+};
+
+/// accumulated cost of the forest engine and of the compiled-in classifier, measured on the same feature vectors
+struct DTForestBenchmark
+{
+  uint64_t numCalls    [NUM_DT_DECISIONS];
+  double   engineTime  [NUM_DT_DECISIONS];   ///< seconds
+  double   compiledTime[NUM_DT_DECISIONS];   ///< seconds
+  double   maxAbsDiff  [NUM_DT_DECISIONS];   ///< largest probability difference between both paths
+
+  DTForestBenchmark() { reset(); }
+
+  void reset();
+  void print() const;
+};
+
+/// read-only forest file, mapped once per process and shared by all encoder instances using the same file; the page
+/// cache holds a single copy of the model for all processes mapping the same file
+class DTForest
+{
+public:
+  static std::shared_ptr<const DTForest> open( const std::string& fileName );
+
+  ~DTForest();
+
+  const DTForestModel*  getModel   ( const DTDecision decision, const int width, const int height ) const;
+  const DTForestEngine& getEngine  ()                                                               const { return m_engine; }
+  const std::string&    getFileName()                                                               const { return m_fileName; }
+
+private:
+  DTForest( const std::string& fileName );
+
+  void xMap   ();
+  void xUnmap ();
+  void xParse ();
+
+  std::string                m_fileName;
+  const uint8_t*             m_data;
+  size_t                     m_size;
+#ifdef _WIN32
+  void*                      m_fileHandle;
+  void*                      m_mapHandle;
+#endif
+  std::vector<DTForestModel> m_models;
+  int                        m_lookup[NUM_DT_DECISIONS][MAX_CU_DEPTH + 1][MAX_CU_DEPTH + 1];
+  DTForestEngine             m_engine;
+};
+
+//! \}
+
+#endif // __DTFOREST__
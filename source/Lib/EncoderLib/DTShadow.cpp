@@ -0,0 +1,181 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTShadow.cpp
+    \brief    shadow evaluation of the DT decisions against the full search
+*/
+
+#include "DTShadow.h"
+
+#include <algorithm>
+#include <cstring>
+
+//! \ingroup EncoderLib
+//! \{
+
+double DTSplitCosts::best() const
+{
+  return std::min( { noSplit, qt, btH, btV, ttH, ttV } );
+}
+
+double DTSplitCosts::kept( const DTCuSlot slot, const int flag ) const
+{
+  switch( slot )
+  {
+  case DT_SLOT_NO_SPLIT:
+    // no split skips all splits, the opposite decision prunes nothing
+    return flag == 1 ? noSplit : best();
+  case DT_SLOT_QT:
+    // QT skips all MTT splits, MTT skips the QT split
+    return flag == 1 ? std::min( noSplit, qt ) : std::min( { noSplit, btH, btV, ttH, ttV } );
+  case DT_SLOT_HOR:
+    // horizontal skips the vertical BT and TT splits and vice versa
+    return flag == 1 ? std::min( { noSplit, qt, btH, ttH } ) : std::min( { noSplit, qt, btV, ttV } );
+  case DT_SLOT_BT_HOR:
+    // binary skips the ternary split of the same direction and vice versa
+    return flag == 1 ? std::min( { noSplit, qt, btH, btV, ttV } ) : std::min( { noSplit, qt, btV, ttH, ttV } );
+  case DT_SLOT_BT_VER:
+    return flag == 1 ? std::min( { noSplit, qt, btH, btV, ttH } ) : std::min( { noSplit, qt, btH, ttH, ttV } );
+  default:
+    return best();
+  }
+}
+
+int DTSplitCosts::trueClass( const DTCuSlot slot ) const
+{
+  double cost0 = MAX_DOUBLE, cost1 = MAX_DOUBLE;
+  switch( slot )
+  {
+  case DT_SLOT_NO_SPLIT: cost0 = noSplit;              cost1 = std::min( { qt, btH, btV, ttH, ttV } ); break;
+  case DT_SLOT_QT:       cost0 = qt;                   cost1 = std::min( { btH, btV, ttH, ttV } );     break;
+  case DT_SLOT_HOR:      cost0 = std::min( btH, ttH ); cost1 = std::min( btV, ttV );                   break;
+  case DT_SLOT_BT_HOR:   cost0 = btH;                  cost1 = ttH;                                    break;
+  case DT_SLOT_BT_VER:   cost0 = btV;                  cost1 = ttV;                                    break;
+  default:                                                                                             break;
+  }
+  return cost0 < MAX_DOUBLE && cost1 < MAX_DOUBLE ? ( cost1 < cost0 ? 1 : 0 ) : -1;
+}
+
+void DTShadowStats::reset()
+{
+  memset( m_stats, 0, sizeof( m_stats ) );
+}
+
+void DTShadowStats::add( const DTDecision decision, const int width, const int height, const double prob, const int flag, const int trueClass, const double loss, const double cost )
+{
+  Stats& stats = m_stats[decision][floorLog2( width ) - MIN_CU_LOG2][floorLog2( height ) - MIN_CU_LOG2];
+  stats.confusion[flag][trueClass]++;
+  stats.probBins[std::min( int( prob * DT_NUM_PROB_BINS ), DT_NUM_PROB_BINS - 1 )][trueClass]++;
+  stats.numLossy += loss > 0.0 ? 1 : 0;
+  stats.lossSum  += loss;
+  stats.costSum  += cost;
+}
+
+void DTShadowStats::print() const
+{
+  const char* name[NUM_DT_DECISIONS] = { "QT/MTT", "Hor/Ver", "BT/TT", "I split", "I QT/MTT", "I Hor/Ver", "Affine", "GEO", "CIIP", "MMVD" };
+
+  for( int dec = 0; dec < NUM_DT_DECISIONS; dec++ )
+  {
+    Stats total;
+    memset( &total, 0, sizeof( total ) );
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        const Stats& stats = m_stats[dec][w][h];
+        for( int f = 0; f < 3; f++ )
+        {
+          total.confusion[f][0] += stats.confusion[f][0];
+          total.confusion[f][1] += stats.confusion[f][1];
+        }
+        for( int b = 0; b < DT_NUM_PROB_BINS; b++ )
+        {
+          total.probBins[b][0] += stats.probBins[b][0];
+          total.probBins[b][1] += stats.probBins[b][1];
+        }
+        total.numLossy += stats.numLossy;
+        total.lossSum  += stats.lossSum;
+        total.costSum  += stats.costSum;
+      }
+    }
+    const uint64_t numTotal = total.confusion[0][0] + total.confusion[0][1] + total.confusion[1][0] + total.confusion[1][1] + total.confusion[2][0] + total.confusion[2][1];
+    if( numTotal == 0 )
+    {
+      continue;
+    }
+
+    msg( INFO, "\nDT shadow %s: %llu predictions", name[dec], (unsigned long long) numTotal );
+    if( dec < DT_DECISION_AFFINE )
+    {
+      msg( INFO, ", RD cost lost by the pruning %.3f%% (%llu CUs)", total.costSum > 0.0 ? 100.0 * total.lossSum / total.costSum : 0.0, (unsigned long long) total.numLossy );
+    }
+    msg( INFO, "\n" );
+    msg( INFO, "                     best class 0  best class 1\n" );
+    msg( INFO, "  predicted class 0  %12llu  %12llu\n", (unsigned long long) total.confusion[1][0], (unsigned long long) total.confusion[1][1] );
+    msg( INFO, "  predicted class 1  %12llu  %12llu\n", (unsigned long long) total.confusion[0][0], (unsigned long long) total.confusion[0][1] );
+    msg( INFO, "  undecided          %12llu  %12llu\n", (unsigned long long) total.confusion[2][0], (unsigned long long) total.confusion[2][1] );
+
+    msg( INFO, "  P(class 1)        " );
+    for( int b = 0; b < DT_NUM_PROB_BINS; b++ )
+    {
+      msg( INFO, "  %3.1f-%3.1f", double( b ) / DT_NUM_PROB_BINS, double( b + 1 ) / DT_NUM_PROB_BINS );
+    }
+    msg( INFO, "\n  CUs (class 1 [%%]) " );
+    for( int b = 0; b < DT_NUM_PROB_BINS; b++ )
+    {
+      const uint64_t n = total.probBins[b][0] + total.probBins[b][1];
+      msg( INFO, " %5llu (%2.0f)", (unsigned long long) n, n > 0 ? 100.0 * total.probBins[b][1] / n : 0.0 );
+    }
+    msg( INFO, "\n" );
+
+    msg( INFO, "  size       predictions  pruned [%%]  accuracy [%%]  lossy   loss [%%]\n" );
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        const Stats&   stats     = m_stats[dec][w][h];
+        const uint64_t num       = stats.confusion[0][0] + stats.confusion[0][1] + stats.confusion[1][0] + stats.confusion[1][1] + stats.confusion[2][0] + stats.confusion[2][1];
+        const uint64_t numPruned = num - stats.confusion[2][0] - stats.confusion[2][1];
+        if( num > 0 )
+        {
+          msg( INFO, "  %3dx%-3d  %13llu  %10.1f  %12.1f  %5llu  %9.3f\n", 1 << ( w + MIN_CU_LOG2 ), 1 << ( h + MIN_CU_LOG2 ), (unsigned long long) num,
+               100.0 * numPruned / num, numPruned > 0 ? 100.0 * ( stats.confusion[1][0] + stats.confusion[0][1] ) / numPruned : 0.0,
+               (unsigned long long) stats.numLossy, stats.costSum > 0.0 ? 100.0 * stats.lossSum / stats.costSum : 0.0 );
+        }
+      }
+    }
+  }
+}
+
+//! \}
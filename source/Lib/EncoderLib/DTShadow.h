@@ -0,0 +1,131 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTShadow.h
+    \brief    shadow evaluation of the DT decisions against the full search (header)
+*/
+
+#ifndef __DTSHADOW__
+#define __DTSHADOW__
+
+#include "CommonLib/CommonDef.h"
+#include "DTForest.h"
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// the DT decisions taken on one CU, the BT/TT decision once per split direction
+enum DTCuSlot
+{
+  DT_SLOT_NO_SPLIT = 0,
+  DT_SLOT_QT,
+  DT_SLOT_HOR,
+  DT_SLOT_BT_HOR,
+  DT_SLOT_BT_VER,
+  DT_SLOT_AFFINE,
+  DT_SLOT_GEO,
+  DT_SLOT_CIIP,
+  DT_SLOT_MMVD,
+  NUM_DT_CU_SLOTS
+};
+
+/// predictions of one CU in shadow mode: what the forests would have decided while the CU is searched in full
+struct DTShadowCU
+{
+  DTDecision decision[NUM_DT_CU_SLOTS];
+  float      prob    [NUM_DT_CU_SLOTS];   ///< probability of class 1, negative if the slot was not predicted
+  int8_t     flag    [NUM_DT_CU_SLOTS];   ///< decision the thresholds would have taken
+  int        toolFlags;                   ///< DTToolFlags of the best non-split mode, -1 if unknown
+
+  DTShadowCU() { reset(); }
+
+  void reset()
+  {
+    for( int s = 0; s < NUM_DT_CU_SLOTS; s++ )
+    {
+      decision[s] = DT_DECISION_QT_MTT;
+      prob    [s] = -1.0f;
+      flag    [s] = 2;
+    }
+    toolFlags = -1;
+  }
+  void set( const DTCuSlot slot, const DTDecision dec, const double p, const int f ) { decision[slot] = dec; prob[slot] = float( p ); flag[slot] = int8_t( f ); }
+};
+
+/// best costs of the non-split modes and of each split of a finished CU, MAX_DOUBLE for the ones not tested
+struct DTSplitCosts
+{
+  double noSplit, qt, btH, btV, ttH, ttV;
+
+  double best     () const;
+  /// best cost of the modes the split decision of a slot leaves, flag 1 choosing no split, QT, horizontal or binary
+  double kept     ( const DTCuSlot slot, const int flag ) const;
+  /// class of the best choice of the split decision of a slot, -1 if one of both choices was not tested
+  int    trueClass( const DTCuSlot slot ) const;
+};
+
+/// confusion matrices of the shadow predictions per decision and block size, and the RD cost the pruning would have lost
+class DTShadowStats
+{
+public:
+  DTShadowStats() { reset(); }
+
+  void reset  ();
+  /// trueClass is the class of the best choice of the full search, loss the cost the decision would have lost (0 if
+  /// it kept the best mode or pruned nothing), cost the best cost of the CU
+  void add    ( const DTDecision decision, const int width, const int height, const double prob, const int flag, const int trueClass, const double loss, const double cost );
+  void print  () const;
+
+private:
+  static const int DT_NUM_SIZES     = MAX_CU_DEPTH - MIN_CU_LOG2 + 1;
+  static const int DT_NUM_PROB_BINS = 10;
+
+  struct Stats
+  {
+    uint64_t confusion[3][2];                   ///< [flag][true class], flag 1 predicts class 0 and flag 0 class 1
+    uint64_t probBins [DT_NUM_PROB_BINS][2];    ///< [probability of class 1][true class]
+    uint64_t numLossy;
+    double   lossSum;
+    double   costSum;
+  };
+
+  Stats  m_stats[NUM_DT_DECISIONS][DT_NUM_SIZES][DT_NUM_SIZES];
+};
+
+//! \}
+
+#endif // __DTSHADOW__
@@ -0,0 +1,83 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTSplitSchedule.cpp
+    \brief    ordering of the split modes of a CU by the DT probabilities
+*/
+
+#include "DTSplitSchedule.h"
+
+#include <algorithm>
+
+//! \ingroup EncoderLib
+//! \{
+
+double DTSplitSchedule::prob( const DTSplitMode mode ) const
+{
+  const double qt  = pQt    < 0.0 ? 0.5 : pQt;
+  const double hor = pHor   < 0.0 ? 0.5 : pHor;
+  const double btH = pBt[0] < 0.0 ? 0.5 : pBt[0];
+  const double btV = pBt[1] < 0.0 ? 0.5 : pBt[1];
+
+  switch( mode )
+  {
+  case DT_SPLIT_QT:     return qt;
+  case DT_SPLIT_BT_HOR: return ( 1 - qt ) * hor * btH;
+  case DT_SPLIT_BT_VER: return ( 1 - qt ) * ( 1 - hor ) * btV;
+  case DT_SPLIT_TT_HOR: return ( 1 - qt ) * hor * ( 1 - btH );
+  case DT_SPLIT_TT_VER: return ( 1 - qt ) * ( 1 - hor ) * ( 1 - btV );
+  default:              return 0.0;
+  }
+}
+
+double DTSplitSchedule::expectedCost( const DTSplitMode mode, const DTSplitCosts& costs, const double margin ) const
+{
+  double refCost = MAX_DOUBLE;
+  switch( mode )
+  {
+  case DT_SPLIT_QT:     refCost = costs.qt;                          break;
+  case DT_SPLIT_BT_HOR:
+  case DT_SPLIT_TT_HOR: refCost = std::min( costs.btH, costs.ttH ); break;
+  case DT_SPLIT_BT_VER:
+  case DT_SPLIT_TT_VER: refCost = std::min( costs.btV, costs.ttV ); break;
+  default:                                                           break;
+  }
+  if( refCost == MAX_DOUBLE )
+  {
+    refCost = std::min( { costs.qt, costs.btH, costs.btV, costs.ttH, costs.ttV } );
+  }
+
+  return refCost == MAX_DOUBLE ? MAX_DOUBLE : refCost * ( 1 - margin * prob( mode ) );
+}
+
+//! \}
@@ -0,0 +1,94 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTSplitSchedule.h
+    \brief    ordering of the split modes of a CU by the DT probabilities (header)
+*/
+
+#ifndef __DTSPLITSCHEDULE__
+#define __DTSPLITSCHEDULE__
+
+#include "CommonLib/CommonDef.h"
+#include "DTShadow.h"
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// split modes of a CU as seen by the split schedule, one per split type whatever the QP
+enum DTSplitMode
+{
+  DT_SPLIT_QT = 0,
+  DT_SPLIT_BT_HOR,
+  DT_SPLIT_BT_VER,
+  DT_SPLIT_TT_HOR,
+  DT_SPLIT_TT_VER,
+  NUM_DT_SPLIT_MODES
+};
+
+/// probabilities of the split decisions of one CU, from which the split modes are tested from the most to the least
+/// likely, and the early termination of the remaining split modes
+struct DTSplitSchedule
+{
+  double pQt;         ///< probability that QT is the better split of QT and MTT, negative if not predicted
+  double pHor;        ///< probability that the better MTT split is horizontal, negative if not predicted
+  double pBt[2];      ///< probability that BT is the better of BT and TT, per direction (horizontal, vertical)
+  bool   active;      ///< the split modes of the CU were ordered by their probabilities
+  bool   terminated;  ///< the remaining split modes of the CU are skipped
+
+  DTSplitSchedule() { reset(); }
+
+  void reset()
+  {
+    pQt        = -1.0;
+    pHor       = -1.0;
+    pBt[0]     = -1.0;
+    pBt[1]     = -1.0;
+    active     = false;
+    terminated = false;
+  }
+
+  /// probability that a split mode is the best split of the CU, a decision not predicted counts as undecided
+  double prob        ( const DTSplitMode mode ) const;
+  /// RD cost a split mode is expected to reach: the best tested cost of its direction (QT for QT), or of all splits if
+  /// none of them was tested, lowered by up to the relative margin as the mode gets more likely; MAX_DOUBLE if no split
+  /// was tested yet
+  double expectedCost( const DTSplitMode mode, const DTSplitCosts& costs, const double margin ) const;
+};
+
+//! \}
+
+#endif // __DTSPLITSCHEDULE__
@@ -0,0 +1,123 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTTelemetry.cpp
+    \brief    statistics of the DT decisions per block size
+*/
+
+#include "DTTelemetry.h"
+
+#include <cstring>
+
+//! \ingroup EncoderLib
+//! \{
+
+void DTTelemetry::reset()
+{
+  memset( m_stats, 0, sizeof( m_stats ) );
+}
+
+void DTTelemetry::add( const DTTelemetry& other )
+{
+  for( int dec = 0; dec < NUM_DT_DECISIONS; dec++ )
+  {
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        Stats&       dst = m_stats[dec][w][h];
+        const Stats& src = other.m_stats[dec][w][h];
+        for( int f = 0; f < 3; f++ )
+        {
+          dst.numFlag[f] += src.numFlag[f];
+        }
+        dst.numSkipped += src.numSkipped;
+        for( int t = 0; t < NUM_TIMERS; t++ )
+        {
+          dst.time[t] += src.time[t];
+        }
+      }
+    }
+  }
+}
+
+void DTTelemetry::printPicture() const
+{
+  uint64_t numPredicted = 0, numPruned = 0, numSkipped = 0;
+  double   time[NUM_TIMERS] = { 0.0, 0.0 };
+  for( int dec = 0; dec < NUM_DT_DECISIONS; dec++ )
+  {
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        const Stats& stats = m_stats[dec][w][h];
+        numPredicted += stats.numFlag[0] + stats.numFlag[1] + stats.numFlag[2];
+        numPruned    += stats.numFlag[0] + stats.numFlag[1];
+        numSkipped   += stats.numSkipped;
+        for( int t = 0; t < NUM_TIMERS; t++ )
+        {
+          time[t] += stats.time[t];
+        }
+      }
+    }
+  }
+
+  msg( NOTICE, " [DT %llu pred %4.1f%% pruned %llu skipped %.0f+%.0f ms]", (unsigned long long) numPredicted,
+       numPredicted > 0 ? 100.0 * numPruned / numPredicted : 0.0, (unsigned long long) numSkipped, 1e3 * time[TIME_FEATURES], 1e3 * time[TIME_INFERENCE] );
+}
+
+void DTTelemetry::print() const
+{
+  const char* name[NUM_DT_DECISIONS] = { "QT/MTT", "Hor/Ver", "BT/TT", "I split", "I QT/MTT", "I Hor/Ver", "Affine", "GEO", "CIIP", "MMVD" };
+
+  msg( INFO, "\nDT telemetry            flag 0      flag 1      flag 2     skipped  features [ms]  inference [ms]\n" );
+  for( int dec = 0; dec < NUM_DT_DECISIONS; dec++ )
+  {
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        const Stats& stats = m_stats[dec][w][h];
+        if( stats.numFlag[0] + stats.numFlag[1] + stats.numFlag[2] + stats.numSkipped > 0 || stats.time[TIME_FEATURES] > 0.0 )
+        {
+          msg( INFO, "  %-9s %3dx%-3d  %10llu  %10llu  %10llu  %10llu  %13.1f  %14.1f\n", name[dec], 1 << ( w + MIN_CU_LOG2 ), 1 << ( h + MIN_CU_LOG2 ),
+               (unsigned long long) stats.numFlag[0], (unsigned long long) stats.numFlag[1], (unsigned long long) stats.numFlag[2],
+               (unsigned long long) stats.numSkipped, 1e3 * stats.time[TIME_FEATURES], 1e3 * stats.time[TIME_INFERENCE] );
+        }
+      }
+    }
+  }
+}
+
+//! \}
@@ -0,0 +1,127 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTTelemetry.h
+    \brief    statistics of the DT decisions per block size (header)
+*/
+
+#ifndef __DTTELEMETRY__
+#define __DTTELEMETRY__
+
+#include "CommonLib/CommonDef.h"
+#include "DTForest.h"
+
+#include <chrono>
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// outcomes of the DT decisions per decision and block size, the split and tool checks they skipped, and the time spent
+/// on the features and on the predictions; each mode controller counts its own, the GOP encoder adds them up per picture
+class DTTelemetry
+{
+public:
+  enum Timer
+  {
+    TIME_FEATURES  = 0,
+    TIME_INFERENCE,
+    NUM_TIMERS
+  };
+
+  DTTelemetry() { reset(); }
+
+  void reset        ();
+  void add          ( const DTTelemetry& other );
+
+  /// flag of a predicted decision: 1 the first choice (no split, QT, horizontal, BT, skip the tool), 0 the second, 2 both
+  void addDecision  ( const DTDecision decision, const int width, const int height, const int flag )          { xStats( decision, width, height ).numFlag[flag]++; }
+  void addSkipped   ( const DTDecision decision, const int width, const int height )                          { xStats( decision, width, height ).numSkipped++; }
+  void addTime      ( const Timer timer, const DTDecision decision, const int width, const int height, const double seconds ) { xStats( decision, width, height ).time[timer] += seconds; }
+
+  /// one-line summary appended to the picture line
+  void printPicture () const;
+  /// table per decision and block size
+  void print        () const;
+
+private:
+  static const int DT_NUM_SIZES = MAX_CU_DEPTH - MIN_CU_LOG2 + 1;
+
+  struct Stats
+  {
+    uint64_t numFlag[3];
+    uint64_t numSkipped;       ///< split or tool checks not tested because of the decision
+    double   time[NUM_TIMERS]; ///< seconds
+  };
+
+  Stats& xStats     ( const DTDecision decision, const int width, const int height ) { return m_stats[decision][floorLog2( width ) - MIN_CU_LOG2][floorLog2( height ) - MIN_CU_LOG2]; }
+
+  Stats  m_stats[NUM_DT_DECISIONS][DT_NUM_SIZES][DT_NUM_SIZES];
+};
+
+/// adds the time of its scope to a DT telemetry counter, does nothing without a telemetry
+class DTTelemetryTimer
+{
+public:
+  DTTelemetryTimer( DTTelemetry* telemetry, const DTTelemetry::Timer timer, const DTDecision decision, const int width, const int height )
+    : m_telemetry( telemetry ), m_timer( timer ), m_decision( decision ), m_width( width ), m_height( height )
+  {
+    if( m_telemetry )
+    {
+      m_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~DTTelemetryTimer()
+  {
+    if( m_telemetry )
+    {
+      m_telemetry->addTime( m_timer, m_decision, m_width, m_height, std::chrono::duration<double>( std::chrono::steady_clock::now() - m_start ).count() );
+    }
+  }
+
+private:
+  DTTelemetry*                          m_telemetry;
+  DTTelemetry::Timer                    m_timer;
+  DTDecision                            m_decision;
+  int                                   m_width;
+  int                                   m_height;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+//! \}
+
+#endif // __DTTELEMETRY__
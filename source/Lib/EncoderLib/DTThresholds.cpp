@@ -0,0 +1,321 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTThresholds.cpp
+    \brief    confidence thresholds of the DT split decisions
+*/
+
+#include "DTThresholds.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//! \ingroup EncoderLib
+//! \{
+
+// the statistics of a block size are evaluated and restarted after this many audits (RD loss target) or predictions
+// (pruning rate target), each evaluation moves its thresholds by one step
+static const int   DT_CONTROL_AUDITS      = 16;
+static const int   DT_CONTROL_PREDICTIONS = 256;
+static const float DT_CONTROL_STEP        = 0.01f;
+
+// the time budget moves the threshold offset by this step per CTU, within [-0.5, 0.5]; the step is enlarged for small
+// slices so that the offset can cover its range within a slice
+static const float DT_BUDGET_STEP         = 0.02f;
+
+// ====================================================================================================================
+// DTThresholds
+// ====================================================================================================================
+
+DTThresholds::DTThresholds()
+{
+  init( 0.9f );
+}
+
+void DTThresholds::init( const float threshold )
+{
+  std::fill_n( &m_threshold[0][0][0][0], sizeof( m_threshold ) / sizeof( float ), threshold );
+}
+
+void DTThresholds::load( const std::string& fileName )
+{
+  std::ifstream file( fileName );
+  CHECK( !file.is_open(), "Cannot open DT threshold file " << fileName );
+
+  // a field is "*" or a single value, returned as the inclusive range [first, last]
+  auto parseRange = [&]( const std::string& field, const int minVal, const int maxVal, const int lineNum, int& first, int& last )
+  {
+    if( field == "*" )
+    {
+      first = minVal;
+      last  = maxVal;
+      return;
+    }
+    std::istringstream iss( field );
+    CHECK( !( iss >> first ) || !iss.eof() || first < minVal || first > maxVal, "DT threshold file " << fileName << ", line " << lineNum << ": invalid value " << field );
+    last = first;
+  };
+
+  std::string line;
+  for( int lineNum = 1; std::getline( file, line ); lineNum++ )
+  {
+    line = line.substr( 0, line.find( '#' ) );
+
+    std::istringstream iss( line );
+    std::string        fields[4];
+    float              threshold;
+    if( !( iss >> fields[0] ) )
+    {
+      continue;
+    }
+    CHECK( !( iss >> fields[1] >> fields[2] >> fields[3] >> threshold ), "DT threshold file " << fileName << ", line " << lineNum << ": expected <decision> <width> <height> <temporal layer> <threshold>" );
+    CHECK( threshold < 0.5f || threshold > 1.0f, "DT threshold file " << fileName << ", line " << lineNum << ": threshold has to be in [0.5, 1]" );
+
+    int firstDec = 0, lastDec = NUM_DT_DECISIONS - 1;
+    if( fields[0] == "qt" )
+    {
+      firstDec = lastDec = DT_DECISION_QT_MTT;
+    }
+    else if( fields[0] == "hv" )
+    {
+      firstDec = lastDec = DT_DECISION_HOR_VER;
+    }
+    else if( fields[0] == "bt" )
+    {
+      firstDec = lastDec = DT_DECISION_BT_TT;
+    }
+    else if( fields[0] == "isplit" )
+    {
+      firstDec = lastDec = DT_DECISION_INTRA_SPLIT;
+    }
+    else if( fields[0] == "iqt" )
+    {
+      firstDec = lastDec = DT_DECISION_INTRA_QT_MTT;
+    }
+    else if( fields[0] == "ihv" )
+    {
+      firstDec = lastDec = DT_DECISION_INTRA_HOR_VER;
+    }
+    else if( fields[0] == "affine" )
+    {
+      firstDec = lastDec = DT_DECISION_AFFINE;
+    }
+    else if( fields[0] == "geo" )
+    {
+      firstDec = lastDec = DT_DECISION_GEO;
+    }
+    else if( fields[0] == "ciip" )
+    {
+      firstDec = lastDec = DT_DECISION_CIIP;
+    }
+    else if( fields[0] == "mmvd" )
+    {
+      firstDec = lastDec = DT_DECISION_MMVD;
+    }
+    else
+    {
+      CHECK( fields[0] != "*", "DT threshold file " << fileName << ", line " << lineNum << ": unknown decision " << fields[0] );
+    }
+
+    int firstW, lastW, firstH, lastH, firstT, lastT;
+    parseRange( fields[1], 1 << MIN_CU_LOG2, 1 << MAX_CU_DEPTH, lineNum, firstW, lastW );
+    parseRange( fields[2], 1 << MIN_CU_LOG2, 1 << MAX_CU_DEPTH, lineNum, firstH, lastH );
+    parseRange( fields[3], 0,                MAX_TLAYER - 1,   lineNum, firstT, lastT );
+    CHECK( ( firstW & ( firstW - 1 ) ) || ( firstH & ( firstH - 1 ) ), "DT threshold file " << fileName << ", line " << lineNum << ": block sizes have to be powers of two" );
+
+    for( int dec = firstDec; dec <= lastDec; dec++ )
+    {
+      for( int t = firstT; t <= lastT; t++ )
+      {
+        for( int w = firstW; w <= lastW; w <<= 1 )
+        {
+          for( int h = firstH; h <= lastH; h <<= 1 )
+          {
+            set( DTDecision( dec ), w, h, t, threshold );
+          }
+        }
+      }
+    }
+  }
+}
+
+void DTThresholds::adjust( const DTDecision decision, const int width, const int height, const float delta )
+{
+  for( int t = 0; t < MAX_TLAYER; t++ )
+  {
+    float& threshold = m_threshold[decision][t][floorLog2( width ) - MIN_CU_LOG2][floorLog2( height ) - MIN_CU_LOG2];
+    threshold = Clip3( 0.5f, 1.0f, threshold + delta );
+  }
+}
+
+// ====================================================================================================================
+// DTThresholdController
+// ====================================================================================================================
+
+DTThresholdController::DTThresholdController()
+{
+  init( 0.0, 0.0, 0.0 );
+}
+
+void DTThresholdController::init( const double auditFraction, const double targetLoss, const double targetPruneRate )
+{
+  m_auditFraction   = auditFraction;
+  m_targetLoss      = targetLoss;
+  m_targetPruneRate = targetPruneRate;
+  m_auditAcc        = 0.0;
+  std::memset( m_stats, 0, sizeof( m_stats ) );
+}
+
+bool DTThresholdController::sampleAudit( const DTDecision decision, const int width, const int height, const bool confident )
+{
+  Stats& stats = xStats( decision, width, height );
+  stats.numPredicted++;
+  stats.totalPredicted++;
+  if( !confident )
+  {
+    return false;
+  }
+  stats.numConfident++;
+  stats.totalConfident++;
+
+  // audits are spread evenly over the confident decisions, which keeps the encoding reproducible
+  m_auditAcc += m_auditFraction;
+  if( m_auditAcc < 1.0 )
+  {
+    return false;
+  }
+  m_auditAcc -= 1.0;
+  return true;
+}
+
+void DTThresholdController::addAudit( const DTDecision decision, const int width, const int height, const double loss, const double cost )
+{
+  Stats& stats = xStats( decision, width, height );
+  stats.numAudited++;
+  stats.totalAudited++;
+  stats.numWrong   += loss > 0.0 ? 1 : 0;
+  stats.totalWrong += loss > 0.0 ? 1 : 0;
+  stats.lossSum    += loss;
+  stats.costSum    += cost;
+}
+
+void DTThresholdController::update( DTThresholds& thresholds )
+{
+  for( int dec = 0; dec < NUM_DT_DECISIONS; dec++ )
+  {
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        Stats& stats = m_stats[dec][w][h];
+        float  delta = 0.0f;
+
+        if( m_targetLoss > 0.0 )
+        {
+          if( stats.numAudited < DT_CONTROL_AUDITS )
+          {
+            continue;
+          }
+          // the loss measured on the audited CUs applies to the confident part of all predicted CUs
+          const double loss = stats.costSum > 0.0 ? stats.lossSum / stats.costSum * stats.numConfident / stats.numPredicted : 0.0;
+          delta = loss > m_targetLoss ? DT_CONTROL_STEP : ( loss < 0.5 * m_targetLoss ? -DT_CONTROL_STEP : 0.0f );
+        }
+        else
+        {
+          if( stats.numPredicted < DT_CONTROL_PREDICTIONS )
+          {
+            continue;
+          }
+          const double pruneRate = double( stats.numConfident ) / stats.numPredicted;
+          delta = pruneRate < m_targetPruneRate ? -DT_CONTROL_STEP : DT_CONTROL_STEP;
+        }
+
+        thresholds.adjust( DTDecision( dec ), 1 << ( w + MIN_CU_LOG2 ), 1 << ( h + MIN_CU_LOG2 ), delta );
+        stats.numPredicted = stats.numConfident = stats.numAudited = stats.numWrong = 0;
+        stats.lossSum      = stats.costSum      = 0.0;
+      }
+    }
+  }
+}
+
+void DTThresholdController::print( const DTThresholds& thresholds ) const
+{
+  const char* name[NUM_DT_DECISIONS] = { "QT/MTT", "Hor/Ver", "BT/TT", "I split", "I QT/MTT", "I Hor/Ver", "Affine", "GEO", "CIIP", "MMVD" };
+
+  msg( INFO, "\nDT threshold control   predicted  pruned [%%]   audits   wrong [%%]  threshold (TL 0)\n" );
+  for( int dec = 0; dec < NUM_DT_DECISIONS; dec++ )
+  {
+    for( int w = 0; w < DT_NUM_SIZES; w++ )
+    {
+      for( int h = 0; h < DT_NUM_SIZES; h++ )
+      {
+        const Stats& stats = m_stats[dec][w][h];
+        if( stats.totalPredicted > 0 )
+        {
+          const int width = 1 << ( w + MIN_CU_LOG2 ), height = 1 << ( h + MIN_CU_LOG2 );
+          msg( INFO, "  %-9s %3dx%-3d  %9d  %10.1f   %6d  %9.1f  %15.3f\n", name[dec], width, height, stats.totalPredicted,
+               100.0 * stats.totalConfident / stats.totalPredicted, stats.totalAudited,
+               stats.totalAudited > 0 ? 100.0 * stats.totalWrong / stats.totalAudited : 0.0, thresholds.get( DTDecision( dec ), width, height, 0 ) );
+        }
+      }
+    }
+  }
+}
+
+// ====================================================================================================================
+// DTTimeBudget
+// ====================================================================================================================
+
+DTTimeBudget::DTTimeBudget( const double budget, const int numCtus )
+  : m_budget ( budget )
+  , m_numCtus( numCtus )
+  , m_step   ( std::max( DT_BUDGET_STEP, 1.0f / std::max( numCtus, 1 ) ) )
+  , m_offset ( 0.0f )
+  , m_start  ( std::chrono::steady_clock::now() )
+{
+}
+
+float DTTimeBudget::update( const int ctuIdx )
+{
+  if( ctuIdx > 0 )
+  {
+    const double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - m_start ).count();
+    const double planned = m_budget * ctuIdx / m_numCtus;
+    m_offset = Clip3( -0.5f, 0.5f, m_offset + ( elapsed > planned ? -m_step : m_step ) );
+  }
+  return m_offset;
+}
+
+//! \}
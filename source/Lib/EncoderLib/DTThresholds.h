@@ -0,0 +1,167 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     DTThresholds.h
+    \brief    confidence thresholds of the DT split decisions (header)
+*/
+
+#ifndef __DTTHRESHOLDS__
+#define __DTTHRESHOLDS__
+
+#include "CommonLib/CommonDef.h"
+#include "DTForest.h"
+
+#include <chrono>
+#include <string>
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// File format
+// ====================================================================================================================
+
+// A threshold file is a text file with one entry per line, '#' starts a comment:
+//
+//   <decision> <width> <height> <temporal layer> <threshold>
+//
+// The decision is "qt" (QT/MTT) or "hv" (Hor/Ver), width and height are block sizes from 4 to 128 and the temporal
+// layer ranges from 0 to MAX_TLAYER-1. Any of these four fields can be "*" to match all values. Entries are applied in
+// file order, so a later line overrides the earlier ones it overlaps; entries not set by the file keep ThresholdDT.
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// thresholds per decision, block size and temporal layer, looked up once per predicted CU
+class DTThresholds
+{
+public:
+  DTThresholds();
+
+  void  init  ( const float threshold );
+  void  load  ( const std::string& fileName );
+
+  float get   ( const DTDecision decision, const int width, const int height, const int tLayer ) const
+  {
+    return m_threshold[decision][std::min( tLayer, MAX_TLAYER - 1 )][floorLog2( width ) - MIN_CU_LOG2][floorLog2( height ) - MIN_CU_LOG2];
+  }
+  void  set   ( const DTDecision decision, const int width, const int height, const int tLayer, const float threshold )
+  {
+    m_threshold[decision][std::min( tLayer, MAX_TLAYER - 1 )][floorLog2( width ) - MIN_CU_LOG2][floorLog2( height ) - MIN_CU_LOG2] = threshold;
+  }
+
+  /// moves the thresholds of a block size on all temporal layers by delta, kept within [0.5, 1]
+  void  adjust( const DTDecision decision, const int width, const int height, const float delta );
+
+  /// 1 if the forest votes for the first class (QT, horizontal) with at least the given confidence, 0 for the second
+  /// class (MTT, vertical) and 2 if undecided; a threshold of 1 is relaxed to 0.975
+  static int decide( const double frac, const float threshold )
+  {
+    const double th = threshold == 1.0f ? 0.975 : threshold;
+    return frac > th ? 1 : ( frac < ( 1 - th ) ? 0 : 2 );
+  }
+
+private:
+  static const int DT_NUM_SIZES = MAX_CU_DEPTH - MIN_CU_LOG2 + 1;
+
+  float m_threshold[NUM_DT_DECISIONS][MAX_TLAYER][DT_NUM_SIZES][DT_NUM_SIZES];
+};
+
+/// adapts the thresholds per decision and block size while encoding: a fraction of the CUs with a confident decision
+/// is searched without pruning to measure the RD cost the pruning would have lost, and the thresholds of a block size
+/// are raised or lowered to meet either a maximum relative RD loss or a target rate of pruned decisions
+class DTThresholdController
+{
+public:
+  DTThresholdController();
+
+  void init         ( const double auditFraction, const double targetLoss, const double targetPruneRate );
+  bool isActive     () const { return m_targetLoss > 0.0 || m_targetPruneRate > 0.0; }
+
+  /// counts a prediction and tells if a confident one is searched without pruning
+  bool sampleAudit  ( const DTDecision decision, const int width, const int height, const bool confident );
+  /// loss is the RD cost of the best mode left by the pruning minus the cost of the best mode of the full search
+  void addAudit     ( const DTDecision decision, const int width, const int height, const double loss, const double cost );
+  void update       ( DTThresholds& thresholds );
+  void print        ( const DTThresholds& thresholds ) const;
+
+private:
+  static const int DT_NUM_SIZES = MAX_CU_DEPTH - MIN_CU_LOG2 + 1;
+
+  struct Stats
+  {
+    int    numPredicted;
+    int    numConfident;
+    int    numAudited;
+    int    numWrong;
+    double lossSum;
+    double costSum;
+    int    totalPredicted; ///< over the whole encoding, for the report
+    int    totalConfident;
+    int    totalAudited;
+    int    totalWrong;
+  };
+
+  Stats& xStats     ( const DTDecision decision, const int width, const int height ) { return m_stats[decision][floorLog2( width ) - MIN_CU_LOG2][floorLog2( height ) - MIN_CU_LOG2]; }
+
+  double m_auditFraction;
+  double m_targetLoss;
+  double m_targetPruneRate;
+  double m_auditAcc;
+  Stats  m_stats[NUM_DT_DECISIONS][DT_NUM_SIZES][DT_NUM_SIZES];
+};
+
+/// offset of the DT thresholds steered per CTU to code a slice within a time budget: the thresholds are lowered (more
+/// decisions prune) while the coding is behind the budget and raised while it is ahead
+class DTTimeBudget
+{
+public:
+  /// budget in seconds for the given number of CTUs, 0 for off
+  DTTimeBudget( const double budget, const int numCtus );
+
+  bool  isActive() const { return m_budget > 0.0; }
+  /// offset to apply to the thresholds while coding the CTU with the given index
+  float update  ( const int ctuIdx );
+
+private:
+  double                                m_budget;
+  int                                   m_numCtus;
+  float                                 m_step;
+  float                                 m_offset;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+//! \}
+
+#endif // __DTTHRESHOLDS__
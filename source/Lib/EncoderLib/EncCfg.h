@@ -297,8 +297,28 @@ protected:
   int       m_numReorderPics[MAX_TLAYER];
   int       m_drapPeriod;
 
-#if RF_TH_CMD
+#if FEATURE_TEST
+  DTMode    m_dtMode;
   float m_threshold_dt;
+  std::string m_thresholdDTFileName;
+  double    m_dtAuditFraction;
+  double    m_dtTargetRDLoss;
+  double    m_dtTargetPruneRate;
+  double    m_dtTimeBudget;
+  std::string m_dtForestFileName;
+  int       m_dtMotionThreads;
+  bool      m_dtMotionLookAhead;
+  bool      m_dtMotionHierarchical;
+  int       m_dtForestBenchmark;
+  bool      m_dtTelemetry;
+  bool      m_dtShadow;
+  DTSplitOrder m_dtSplitOrder;
+  double    m_dtSplitOrderMargin;
+  std::string m_dtDatasetName;
+  int       m_dtSamplePocStride;
+  std::vector<int> m_dtSamplePocs;
+  double    m_dtSampleCtuFraction;
+  int       m_dtSampleBlockCap;
 #endif
 
 
@@ -1494,9 +1514,49 @@ public:
   void      setSliceLosslessArray(std::vector<uint16_t> sliceLosslessArray) { m_sliceLosslessArray = sliceLosslessArray; }
   const     std::vector<uint16_t>*   getSliceLosslessArray() const { return &m_sliceLosslessArray; }
 
-#if RF_TH_CMD
+#if FEATURE_TEST
+  DTMode    getDTMode() const                                                { return m_dtMode;                          }
+  void      setDTMode( DTMode m )                                            { m_dtMode = m;                             }
   float     getThresholdDT()const                                            { return m_threshold_dt;                    }
   void      setThresholdDT( float t )                                        { m_threshold_dt = t;                       }
+  const std::string& getThresholdDTFileName() const                          { return m_thresholdDTFileName;             }
+  void      setThresholdDTFileName( const std::string& s )                   { m_thresholdDTFileName = s;                }
+  double    getDTAuditFraction() const                                       { return m_dtAuditFraction;                 }
+  void      setDTAuditFraction( double d )                                   { m_dtAuditFraction = d;                    }
+  double    getDTTargetRDLoss() const                                        { return m_dtTargetRDLoss;                  }
+  void      setDTTargetRDLoss( double d )                                    { m_dtTargetRDLoss = d;                     }
+  double    getDTTargetPruneRate() const                                     { return m_dtTargetPruneRate;               }
+  void      setDTTargetPruneRate( double d )                                 { m_dtTargetPruneRate = d;                  }
+  double    getDTTimeBudget() const                                          { return m_dtTimeBudget;                    }
+  void      setDTTimeBudget( double d )                                      { m_dtTimeBudget = d;                       }
+  const std::string& getDTForestFileName() const                             { return m_dtForestFileName;                }
+  void      setDTForestFileName( const std::string& s )                      { m_dtForestFileName = s;                   }
+  int       getDTMotionThreads() const                                       { return m_dtMotionThreads;                 }
+  void      setDTMotionThreads( int n )                                      { m_dtMotionThreads = n;                    }
+  bool      getDTMotionLookAhead() const                                     { return m_dtMotionLookAhead;               }
+  void      setDTMotionLookAhead( bool b )                                   { m_dtMotionLookAhead = b;                  }
+  bool      getDTMotionHierarchical() const                                  { return m_dtMotionHierarchical;            }
+  void      setDTMotionHierarchical( bool b )                                { m_dtMotionHierarchical = b;               }
+  int       getDTForestBenchmark() const                                     { return m_dtForestBenchmark;               }
+  void      setDTForestBenchmark( int n )                                    { m_dtForestBenchmark = n;                  }
+  bool      getDTTelemetry() const                                           { return m_dtTelemetry;                     }
+  void      setDTTelemetry( bool b )                                         { m_dtTelemetry = b;                        }
+  bool      getDTShadow() const                                              { return m_dtShadow;                        }
+  void      setDTShadow( bool b )                                            { m_dtShadow = b;                           }
+  DTSplitOrder getDTSplitOrder() const                                       { return m_dtSplitOrder;                    }
+  void      setDTSplitOrder( DTSplitOrder o )                                { m_dtSplitOrder = o;                       }
+  double    getDTSplitOrderMargin() const                                    { return m_dtSplitOrderMargin;              }
+  void      setDTSplitOrderMargin( double d )                                { m_dtSplitOrderMargin = d;                 }
+  const std::string& getDTDatasetName() const                                { return m_dtDatasetName;                   }
+  void      setDTDatasetName( const std::string& s )                         { m_dtDatasetName = s;                      }
+  int       getDTSamplePocStride() const                                     { return m_dtSamplePocStride;               }
+  void      setDTSamplePocStride( int n )                                    { m_dtSamplePocStride = n;                  }
+  const std::vector<int>& getDTSamplePocs() const                            { return m_dtSamplePocs;                    }
+  void      setDTSamplePocs( const std::vector<int>& pocs )                  { m_dtSamplePocs = pocs;                    }
+  double    getDTSampleCtuFraction() const                                   { return m_dtSampleCtuFraction;             }
+  void      setDTSampleCtuFraction( double d )                               { m_dtSampleCtuFraction = d;                }
+  int       getDTSampleBlockCap() const                                      { return m_dtSampleBlockCap;                }
+  void      setDTSampleBlockCap( int n )                                     { m_dtSampleBlockCap = n;                   }
 #endif
 
   //====== Tiles and Slices ========
@@ -255,7 +255,7 @@ void EncCu::init( EncLib* pcEncLib, const SPS& sps PARL_PARAM( const int tId ) )
 
 void EncCu::compressCtu( CodingStructure& cs, const UnitArea& area, const unsigned ctuRsAddr, const int prevQP[], const int currQP[] )
 {
-  m_modeCtrl->initCTUEncoding( *cs.slice );
+  m_modeCtrl->initCTUEncoding( *cs.slice, ctuRsAddr );
   cs.treeType = TREE_D;
 
   cs.slice->m_mapPltCost[0].clear();
@@ -2309,7 +2309,13 @@ void EncCu::xCheckRDCostMerge2Nx2N( CodingStructure *&tempCS, CodingStructure *&
 
   static_vector<ModeInfo, MRG_MAX_NUM_CANDS + MMVD_ADD_NUM>  RdModeList;
   bool                                        mrgTempBufSet = false;
-  const int candNum = mergeCtx.numValidMergeCand + (tempCS->sps->getUseMMVD() ? std::min<int>(MMVD_BASE_MV_NUM, mergeCtx.numValidMergeCand) * MMVD_MAX_REFINE_NUM : 0);
+#if FEATURE_TEST
+  // CIIP and MMVD are not checked if the DT tool decisions predict that the CU will not use them
+  const bool useMMVD = tempCS->sps->getUseMMVD() && !m_modeCtrl->skipDTInterTool( DT_DECISION_MMVD );
+#else
+  const bool useMMVD = tempCS->sps->getUseMMVD();
+#endif
+  const int candNum = mergeCtx.numValidMergeCand + (useMMVD ? std::min<int>(MMVD_BASE_MV_NUM, mergeCtx.numValidMergeCand) * MMVD_MAX_REFINE_NUM : 0);
 
   for (int i = 0; i < candNum; i++)
   {
@@ -2342,6 +2348,12 @@ void EncCu::xCheckRDCostMerge2Nx2N( CodingStructure *&tempCS, CodingStructure *&
   {
     isIntrainterEnabled = false;
   }
+#if FEATURE_TEST
+  if (m_modeCtrl->skipDTInterTool( DT_DECISION_CIIP ))
+  {
+    isIntrainterEnabled = false;
+  }
+#endif
   bool isTestSkipMerge[MRG_MAX_NUM_CANDS]; // record if the merge candidate has tried skip mode
   for (uint32_t idx = 0; idx < MRG_MAX_NUM_CANDS; idx++)
   {
@@ -2526,7 +2538,7 @@ void EncCu::xCheckRDCostMerge2Nx2N( CodingStructure *&tempCS, CodingStructure *&
         }
         pu.ciipFlag = false;
       }
-      if ( pu.cs->sps->getUseMMVD() )
+      if ( useMMVD )
       {
         cu.mmvdSkip = true;
         pu.regularMergeFlag = true;
@@ -196,12 +196,13 @@ void  EncGOP::destroy()
     delete m_picBg;
     m_picBg = NULL;
   }
+#if FEATURE_TEST
+  m_motionField.destroy();
+  m_motionFieldPool.destroy();
+#endif
   if (m_picOrig)
   {
     m_picOrig->destroy();
-#if FEATURE_TEST
-	m_picOrig->destroyMv();
-#endif
     delete m_picOrig;
     m_picOrig = NULL;
   }
@@ -213,6 +214,11 @@ void EncGOP::init ( EncLib* pcEncLib )
   m_pcCfg                = pcEncLib;
   m_seiEncoder.init(m_pcCfg, pcEncLib, this);
   m_pcSliceEncoder       = pcEncLib->getSliceEncoder();
+#if FEATURE_TEST
+  m_motionField.init( m_pcCfg->getDTMotionThreads(), m_pcCfg->getMaxCUWidth(), m_pcCfg->getMaxCUHeight(), m_pcCfg->getDTMotionHierarchical(), m_pcEncLib->getMotionCache() );
+  // with look-ahead the fields of a whole GOP are in flight at once
+  m_motionFieldPool.create( Size( m_pcCfg->getSourceWidth(), m_pcCfg->getSourceHeight() ), m_pcCfg->getDTMotionLookAhead() ? m_pcCfg->getGOPSize() + 1 : 1 );
+#endif
   m_pcListPic            = pcEncLib->getListPic();
   m_HLSWriter            = pcEncLib->getHLSWriter();
   m_pcLoopFilter         = pcEncLib->getLoopFilter();
@@ -1953,6 +1959,13 @@ void EncGOP::compressGOP( int iPOCLast, int iNumPicRcvd, PicList& rcListPic,
 
   xInitGOP( iPOCLast, iNumPicRcvd, isField, isEncodeLtRef );
 
+#if FEATURE_TEST && FEATURE_EXTRACTION_DIAMOND
+  if( m_pcCfg->getDTMode() != DT_MODE_OFF && m_pcCfg->getDTMotionLookAhead() && picIdInGOP == 0 && iPOCLast != 0 && !isField && !m_pcCfg->getUseCompositeRef() )
+  {
+    xScheduleMotionLookAhead( iPOCLast, iNumPicRcvd, rcListPic );
+  }
+#endif
+
   m_iNumPicCoded = 0;
   SEIMessages leadingSeiMessages;
   SEIMessages nestedSeiMessages;
@@ -2696,153 +2709,44 @@ void EncGOP::compressGOP( int iPOCLast, int iNumPicRcvd, PicList& rcListPic,
 
 
 #if FEATURE_TEST
-#if FEATURE_EXTRACTION_DIAMOND
-	if (pcSlice->getSliceType() != I_SLICE)
+	// without DT inference or collection the search is left as in the anchor, no features are extracted
+	// the integral images also serve the intra decisions, the motion field only the inter ones
+	const bool dtFeatures = m_pcCfg->getDTMode() != DT_MODE_OFF && pcSlice->getSliceType() != I_SLICE;
+	if (m_pcCfg->getDTMode() != DT_MODE_OFF)
 	{
-		const CPelBuf orgPel = pcSlice->getPic()->getOrigBuf(COMPONENT_Y);
-		const CPelBuf refPel = pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getRecoBuf(COMPONENT_Y);
-		int diamondLocations[9][2] = { {0,0}, {0,2}, {1,1} , {2,0}, {1,-1}, {0,-2}, {-1,-1}, {-2,0}, {-1,1} };
-		int diamondLocationsSmall[4][2] = { {0,1}, {1,0}, {-1,0}, {0,-1}};
-
-
-		Mv* mvArray = pcSlice->getPic()->getMvArray();
-		int* sadArray = pcSlice->getPic()->getSADErr();
-		int distScale = (pcSlice->getPOC() - pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getPOC());
-		int ht = pcPic->lheight();
-		int wd = pcPic->lwidth();
-		Mv* mvPtr;
-		int* sadPtr;
-
-		auto meError = [&](int xOrg ,int yOrg, int xRef, int yRef)
-		{
-			double absSum = 0.0;
-			for (int yy = 0; yy < 4; yy++)
-			{
-				for (int xx = 0; xx < 4; xx++)
-				{
-					const Pel* ptrOrg = orgPel.bufAt(xOrg + xx, yOrg + yy);
-					const Pel* ptrRef = refPel.bufAt(xRef + xx, yRef + yy);
-					absSum += abs(*ptrOrg - *ptrRef);
-				}
-			}
-			return absSum;
-		};
-
-		
-		for (int yOrg = 0; yOrg < ht; yOrg = yOrg + 4)
+		m_featureIntegrals.compute(pcPic->getOrigBuf(COMPONENT_Y), pcSlice->getSPS()->getBitDepth(CHANNEL_TYPE_LUMA));
+		pcPic->setFeatureIntegrals(&m_featureIntegrals);
+	}
+	if (dtFeatures)
+	{
+		if (pcPic->getMotionField() == nullptr)
 		{
-			for (int xOrg = 0; xOrg < wd; xOrg = xOrg + 4)
-			{
-				int x = 0, y = 0, bestX = 0, bestY = 0, prevBestX = 0, prevBestY = 0;
-				double minSum = MAX_DOUBLE;
-				bool testNext = true;
-				int iter = 0; 
-				int p = 64;
-				int prevDiamondLoc[9][2] = { {p,p}, {p,p}, {p,p} , {p,p}, {p,p}, {p,p}, {p,p}, {p,p}, {p,p} };
-				do
-				{
-					prevBestX = bestX;  prevBestY = bestY;
-					x = bestX; y = bestY;
-					int currDiamondLoc[9][2] = { {0,0}, {0,0}, {0,0} , {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0} };
-
-					for (int i = 0; i < 9; i++)
-					{
-						int mvX = (x + diamondLocations[i][0]);
-						int mvY = (y + diamondLocations[i][1]);
-						int xRef = xOrg + (mvX) * distScale;
-						int yRef = yOrg + (mvY) * distScale;
-
-						currDiamondLoc[i][0] = mvX;
-						currDiamondLoc[i][1] = mvY;
-
-						bool boundary = xRef < -(maxCUWidth + 16) || (xRef > (wd + maxCUWidth + 12));
-						boundary = boundary || (yRef < -(maxCUHeight + 16) || (yRef > (ht + maxCUHeight + 12)));
-
-						bool limit = mvX < -p || mvX > p;
-						limit = limit || mvY < -p || mvY > p;
-
-						if (boundary || limit)
-						{
-							continue;
-						}
-
-						bool foundMatch = false;
-						if (iter)
-						{
-							for (int ii = 0; ii < 9; ii++)
-							{
-								if ((mvX == prevDiamondLoc[ii][0]) && (mvY == prevDiamondLoc[ii][1]))
-								{
-									foundMatch = true;
-									break;
-								}
-							}
-						}
-
-						if (foundMatch)
-							continue;
-
-						double cost = meError(xOrg, yOrg, xRef, yRef);
-						if (minSum > cost)
-						{
-							minSum = cost;
-							bestX = mvX;
-							bestY = mvY;
-						}
-					}
-					if (prevBestX == bestX && prevBestY == bestY)
-						testNext = false;
-					
-					if (testNext)
-					{
-						for (int ii = 0; ii < 9; ii++)
-						{
-							prevDiamondLoc[ii][0] = currDiamondLoc[ii][0];
-							prevDiamondLoc[ii][1] = currDiamondLoc[ii][1];
-						}
-					}
-					iter++;
-					//std::cout << "(x,y):" << xOrg <<"," << yOrg << " (bestX, bestY):" << bestX << "," << bestY << " error:" << minSum << std::endl;
-
-				} while (testNext);
-
+			pcPic->setMotionField(m_motionFieldPool.acquire(pcPic->lumaSize()));
+		}
+	}
 
-				x = bestX; y = bestY;
-				for (int i = 0; i < 4; i++)
-				{
-					int xRef = xOrg + (x + diamondLocationsSmall[i][0]) * distScale;
-					int yRef = yOrg + (y + diamondLocationsSmall[i][1]) * distScale;
+#if FEATURE_EXTRACTION_DIAMOND
+	const int lookAheadRefPoc = dtFeatures && m_pcCfg->getDTMotionLookAhead() ? m_motionField.waitLookAhead(pcPic) : -1;
 
-					double cost = meError(xOrg, yOrg, xRef, yRef);
-					if (minSum > cost)
-					{
-						minSum = cost;
-						bestX = (x + diamondLocationsSmall[i][0]);
-						bestY = (y + diamondLocationsSmall[i][1]);
-					}
-				}
+	if (dtFeatures && lookAheadRefPoc != pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getPOC())
+	{
+		// in look-ahead mode the motion field is always estimated between the true originals, as in the look-ahead jobs
+		const CPelBuf orgPel = m_pcCfg->getDTMotionLookAhead() ? pcSlice->getPic()->getTrueOrigBuf().get(COMPONENT_Y) : pcSlice->getPic()->getOrigBuf(COMPONENT_Y);
+		const CPelBuf refPel = m_pcCfg->getDTMotionLookAhead() ? pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getTrueOrigBuf().get(COMPONENT_Y) : pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getRecoBuf(COMPONENT_Y);
 
-				//std::cout << "\\Final (x,y):" << xOrg << "," << yOrg << " (bestX, bestY):" << bestX << "," << bestY << " error:" << minSum << std::endl;
-				
-				mvPtr = mvArray + (yOrg / 4) * (wd / 4) + (xOrg / 4);
-				(*mvPtr).setHor(bestX); (*mvPtr).setVer(bestY);
-				sadPtr = sadArray + (yOrg / 4) * (wd / 4) + (xOrg / 4);
-				(*sadPtr) = (int)minSum;
-			}
-		}
+		m_motionField.estimate(orgPel, refPel, !m_pcCfg->getDTMotionLookAhead(), pcSlice->getPOC(), pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getPOC(), pcSlice->getSPS()->getBitDepth(CHANNEL_TYPE_LUMA), *pcPic->getMotionField());
 	}
 
 #else
-	if (pcSlice->getSliceType() != I_SLICE)
+	if (dtFeatures)
 	{
 		const CPelBuf orgPel = pcSlice->getPic()->getOrigBuf(COMPONENT_Y);
 		const CPelBuf refPel = pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getRecoBuf(COMPONENT_Y);
-		Mv* mvArray = pcSlice->getPic()->getMvArray();
+		MotionField* field = pcPic->getMotionField();
 		int distScale = (pcSlice->getPOC() - pcSlice->getRefPic(REF_PIC_LIST_0, 0)->getPOC());
 		double sumX = 0, squaredSumX = 0, sumY = 0, squaredSumY = 0;
 		int ht = pcPic->lheight();
 		int wd = pcPic->lwidth();
-		Mv* mvPtr;
 		for (int y = 0; y < ht; y = y + 4)
 		{
 			for (int x = 0; x < wd; x = x + 4)
@@ -2850,7 +2754,6 @@ void EncGOP::compressGOP( int iPOCLast, int iNumPicRcvd, PicList& rcListPic,
 				int p = 7;
 				int minSum = MAX_INT;
 				int bestX = -p, bestY = -p;
-				mvPtr = mvArray + (y / 4) * (wd / 4) + (x / 4);
 				for (int j = -p; j <= p; j++)
 				{
 					for (int i = -p; i <= p; i++)
@@ -2874,7 +2777,7 @@ void EncGOP::compressGOP( int iPOCLast, int iNumPicRcvd, PicList& rcListPic,
 					}
 				}
 
-				(*mvPtr).setHor(bestX); (*mvPtr).setVer(bestY);
+				field->setMv((y / 4) * field->getNumBlkCols() + (x / 4), Mv(bestX, bestY));
 			}
 		}
 	}
@@ -3073,6 +2976,12 @@ void EncGOP::compressGOP( int iPOCLast, int iNumPicRcvd, PicList& rcListPic,
           uiNumSliceSegments++;
         }
       }
+#if FEATURE_TEST
+      pcPic->setFeatureIntegrals(nullptr);
+      m_pcEncLib->getMotionCache()->release(pcPic->getPOC());
+      m_motionFieldPool.release(pcPic->getMotionField());
+      pcPic->setMotionField(nullptr);
+#endif
 
       duData.clear();
 
@@ -3863,6 +3772,14 @@ void EncGOP::compressGOP( int iPOCLast, int iNumPicRcvd, PicList& rcListPic,
     pcPic->cs->releaseIntermediateData();
   } // iGOPid-loop
 
+#if FEATURE_TEST && FEATURE_EXTRACTION_DIAMOND
+  // the picture buffers of the GOP may be reused once its last picture is coded
+  if( m_pcCfg->getDTMode() != DT_MODE_OFF && m_pcCfg->getDTMotionLookAhead() && picIdInGOP == m_iGopSize - 1 )
+  {
+    m_motionField.flushLookAhead();
+  }
+#endif
+
   delete pcBitstreamRedirect;
 
   CHECK( m_iNumPicCoded > 1, "Unspecified error" );
@@ -3976,6 +3893,12 @@ void EncGOP::printOutSummary( uint32_t uiNumAllPicCoded, bool isField, const boo
   }
 
   msg( DETAILS,"\nRVM: %.3lf\n", xCalculateRVM() );
+#if FEATURE_TEST
+  if( m_pcCfg->getDTTelemetry() )
+  {
+    m_dtTelemetry.print();
+  }
+#endif
 }
 
 #if W0038_DB_OPT
@@ -4066,6 +3989,80 @@ void EncGOP::xGetBuffer( PicList&                  rcListPic,
   return;
 }
 
+#if FEATURE_TEST
+/** Collects the DT telemetry of the mode controllers since the previous picture, prints its summary on the picture line
+ *  and adds it to the sequence statistics.
+ */
+void EncGOP::xAddDTTelemetry()
+{
+  DTTelemetry picture;
+#if ENABLE_SPLIT_PARALLELISM
+  for( int jId = 0; jId < m_pcEncLib->getNumCuEncStacks(); jId++ )
+  {
+    DTTelemetry* telemetry = m_pcEncLib->getCuEncoder( jId )->getModeCtrl()->getDTTelemetry();
+#else
+  {
+    DTTelemetry* telemetry = m_pcEncLib->getCuEncoder()->getModeCtrl()->getDTTelemetry();
+#endif
+    if( telemetry )
+    {
+      picture.add( *telemetry );
+      telemetry->reset();
+    }
+  }
+
+  picture.printPicture();
+  m_dtTelemetry.add( picture );
+}
+
+/** Hands the inter pictures of the GOP to the motion field look-ahead in coding order.
+ *  All originals of the GOP are available before its first picture is coded. The reference is predicted
+ *  from the first entry of the GOP's L0 list; a picture whose actual reference differs is estimated again
+ *  when it is coded.
+ */
+void EncGOP::xScheduleMotionLookAhead( int iPOCLast, int iNumPicRcvd, PicList& rcListPic )
+{
+  m_motionField.flushLookAhead();
+
+  auto findPic = [&]( const int poc ) -> Picture*
+  {
+    for( Picture* pic : rcListPic )
+    {
+      if( pic->getPOC() == poc && pic->layerId == m_pcEncLib->getLayerId() )
+      {
+        return pic;
+      }
+    }
+    return nullptr;
+  };
+
+  for( int iGOPid = 0; iGOPid < m_iGopSize; iGOPid++ )
+  {
+    const int pocCurr = iPOCLast - iNumPicRcvd + m_pcCfg->getGOPEntry( iGOPid ).m_POC;
+    const RPLEntry& rpl = m_pcCfg->getRPLEntry( 0, iGOPid );
+
+    if( pocCurr >= m_pcCfg->getFramesToBeEncoded() || rpl.m_numRefPics == 0 || ( m_pcCfg->getIntraPeriod() > 0 && pocCurr % m_pcCfg->getIntraPeriod() == 0 ) )
+    {
+      continue;
+    }
+
+    Picture* pic    = findPic( pocCurr );
+    Picture* refPic = findPic( pocCurr - rpl.m_deltaRefPics[0] );
+
+    if( pic == nullptr || refPic == nullptr || pic->lwidth() != refPic->lwidth() || pic->lheight() != refPic->lheight() )
+    {
+      continue;
+    }
+
+    if( pic->getMotionField() == nullptr )
+    {
+      pic->setMotionField( m_motionFieldPool.acquire( pic->lumaSize() ) );
+    }
+    m_motionField.scheduleLookAhead( pic, refPic, pic->cs->sps->getBitDepth( CHANNEL_TYPE_LUMA ) );
+  }
+}
+#endif
+
 #if ENABLE_QPA
 
 #ifndef BETA
@@ -4707,6 +4704,12 @@ void EncGOP::xCalculateAddPSNR(Picture* pcPic, PelUnitBuf cPicD, const AccessUni
     }
 #endif
     msg( NOTICE, " [ET %5.0f ]", dEncTime );
+#if FEATURE_TEST
+    if( m_pcCfg->getDTTelemetry() )
+    {
+      xAddDTTelemetry();
+    }
+#endif
 
     // msg( SOME, " [WP %d]", pcSlice->getUseWeightedPrediction());
 
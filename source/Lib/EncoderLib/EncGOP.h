@@ -61,6 +61,7 @@
 #include "RateCtrl.h"
 #include <vector>
 #include "EncHRD.h"
+#include "EncMotionField.h"
 
 #if JVET_O0756_CALCULATE_HDRMETRICS
 #include "HDRLib/inc/ConvertColorFormat.H"
@@ -143,6 +144,12 @@ private:
 
   Picture *               m_picBg;
   Picture *               m_picOrig;
+#if FEATURE_TEST
+  FeatureIntegrals        m_featureIntegrals;
+  EncMotionField          m_motionField;
+  MotionFieldPool         m_motionFieldPool;
+  DTTelemetry             m_dtTelemetry;                      ///< DT decisions of the coded pictures
+#endif
   int                     m_bgPOC;
   bool                    m_isEncodedLTRef;
   bool                    m_isPrepareLTRef;
@@ -268,6 +275,10 @@ protected:
   void  xPicInitLMCS       (Picture *pic, PicHeader *picHeader, Slice *slice);
   void  xGetBuffer        ( PicList& rcListPic, std::list<PelUnitBuf*>& rcListPicYuvRecOut,
                             int iNumPicRcvd, int iTimeOffset, Picture*& rpcPic, int pocCurr, bool isField );
+#if FEATURE_TEST
+  void  xScheduleMotionLookAhead( int iPOCLast, int iNumPicRcvd, PicList& rcListPic );
+  void  xAddDTTelemetry         ();
+#endif
 
 #if JVET_O0756_CALCULATE_HDRMETRICS
   void xCalculateHDRMetrics ( Picture* pcPic, double deltaE[hdrtoolslib::NB_REF_WHITE], double psnrL[hdrtoolslib::NB_REF_WHITE]);
@@ -110,6 +110,9 @@ private:
 
   // processing unit
   EncGOP                    m_cGOPEncoder;                        ///< GOP encoder
+#if FEATURE_TEST
+  MotionAnalysisCache       m_motionCache;                        ///< motion fields shared by the temporal filter and the DT features
+#endif
   EncSlice                  m_cSliceEncoder;                      ///< slice encoder
 #if ENABLE_SPLIT_PARALLELISM
   EncCu                    *m_cCuEncoder;                         ///< CU encoder
@@ -207,6 +210,9 @@ public:
   EncSampleAdaptiveOffset* getSAO               ()              { return  &m_cEncSAO;              }
   EncAdaptiveLoopFilter*  getALF                ()              { return  &m_cEncALF;              }
   EncGOP*                 getGOPEncoder         ()              { return  &m_cGOPEncoder;          }
+#if FEATURE_TEST
+  MotionAnalysisCache*    getMotionCache        ()              { return  &m_motionCache;          }
+#endif
   EncSlice*               getSliceEncoder       ()              { return  &m_cSliceEncoder;        }
   EncHRD*                 getHRD                ()              { return  &m_encHRD;               }
 #if ENABLE_SPLIT_PARALLELISM
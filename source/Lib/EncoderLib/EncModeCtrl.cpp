@@ -47,20 +47,11 @@
 
 #include "CommonLib/dtrace_next.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
 
-#if COLLECT_DATASET
-void WriteFormatted_features ( FILE* f, const char * format, ... )
-{
-  va_list args;
-  va_start ( args, format );
-  vfprintf ( f, format, args );
-  fflush( f );
-  va_end ( args );
-}
-#endif
-
 
 void EncModeCtrl::init( EncCfg *pCfg, RateCtrl *pRateCtrl, RdCost* pRdCost )
 {
@@ -68,6 +59,9 @@ void EncModeCtrl::init( EncCfg *pCfg, RateCtrl *pRateCtrl, RdCost* pRdCost )
   m_pcRateCtrl    = pRateCtrl;
   m_pcRdCost      = pRdCost;
   m_fastDeltaQP   = false;
+#if FEATURE_TEST
+  m_dtThresholdOffset = 0.0f;
+#endif
 #if SHARP_LUMA_DELTA_QP
   m_lumaQPOffset  = 0;
 
@@ -266,6 +260,9 @@ void EncModeCtrl::copyState( const EncModeCtrl& other, const UnitArea& area )
 {
   m_slice          = other.m_slice;
   m_fastDeltaQP    = other.m_fastDeltaQP;
+#if FEATURE_TEST
+  m_dtThresholdOffset = other.m_dtThresholdOffset;
+#endif
   m_lumaQPOffset   = other.m_lumaQPOffset;
   m_runNextInParallel
                    = other.m_runNextInParallel;
@@ -622,6 +619,32 @@ uint8_t CacheBlkInfoCtrl::getBcwIdx(const UnitArea& area)
   return m_codedCUInfo[idx1][idx2][idx3][idx4]->BcwIdx;
 }
 
+#if FEATURE_TEST
+void DTFeatureCache::create()
+{
+  m_entries.assign( NUM_POS * NUM_POS * NUM_SIZES * NUM_SIZES, DTCachedFeatures() );
+  m_ctuStamp = 0;
+}
+
+DTCachedFeatures& DTFeatureCache::get( const CompArea& area, const int qp, bool& cached )
+{
+  const int x = ( area.x & ( MAX_CU_SIZE - 1 ) ) >> MIN_CU_LOG2;
+  const int y = ( area.y & ( MAX_CU_SIZE - 1 ) ) >> MIN_CU_LOG2;
+  const int w = floorLog2( area.width  ) - 3;
+  const int h = floorLog2( area.height ) - 3;
+  CHECK( w < 0 || h < 0, "DT features are only cached for CUs of at least 8x8" );
+
+  DTCachedFeatures& entry = m_entries[( ( x * NUM_POS + y ) * NUM_SIZES + w ) * NUM_SIZES + h];
+
+  // the QP is a feature and may change between the CUs of a CTU
+  cached         = entry.ctuStamp == m_ctuStamp && entry.qp == qp;
+  entry.ctuStamp = m_ctuStamp;
+  entry.qp       = qp;
+
+  return entry;
+}
+#endif
+
 #if REUSE_CU_RESULTS
 static bool isTheSameNbHood( const CodingUnit &cu, const CodingStructure& cs, const Partitioner &partitioner
                             , const PredictionUnit &pu, int picW, int picH
@@ -1093,6 +1116,34 @@ void EncModeCtrlMTnoRQT::create( const EncCfg& cfg )
   BestEncInfoCache::create( cfg.getChromaFormatIdc() );
 #endif
   SaveLoadEncInfoSbt::create();
+#if FEATURE_TEST
+  m_dtInfer = ( cfg.getDTMode() & DT_MODE_INFER ) != 0;
+  m_dtThresholds.init( cfg.getThresholdDT() );
+  if( m_dtInfer && !cfg.getThresholdDTFileName().empty() )
+  {
+    m_dtThresholds.load( cfg.getThresholdDTFileName() );
+  }
+  m_dtControl.init( m_dtInfer ? cfg.getDTAuditFraction() : 0.0, m_dtInfer ? cfg.getDTTargetRDLoss() : 0.0, m_dtInfer ? cfg.getDTTargetPruneRate() : 0.0 );
+  if( m_dtInfer && !cfg.getDTForestFileName().empty() )
+  {
+    m_dtForest = DTForest::open( cfg.getDTForestFileName() );
+  }
+  m_dtBenchmarkReps = m_dtForest ? cfg.getDTForestBenchmark() : 0;
+  m_dtBenchmark.reset();
+  m_dtFeatureCache.create();
+  m_dtTelemetry.reset( m_dtInfer && cfg.getDTTelemetry() ? new DTTelemetry : nullptr );
+  m_dtShadow = m_dtInfer && cfg.getDTShadow();
+  m_dtSplitOrder       = m_dtInfer ? cfg.getDTSplitOrder() : DT_SPLIT_ORDER_OFF;
+  m_dtSplitOrderMargin = cfg.getDTSplitOrderMargin();
+  m_dtShadowStats.reset();
+
+  if( cfg.getDTMode() & DT_MODE_COLLECT )
+  {
+    m_dtDataset = DTDatasetWriter::open( cfg.getDTDatasetName(), cfg.getDTSampleBlockCap() );
+    m_dtSampling.init( cfg.getDTSamplePocStride(), cfg.getDTSamplePocs(), cfg.getDTSampleCtuFraction() );
+  }
+  m_dtCollectCtu = false;
+#endif
 }
 
 void EncModeCtrlMTnoRQT::destroy()
@@ -1102,9 +1153,26 @@ void EncModeCtrlMTnoRQT::destroy()
   BestEncInfoCache::destroy();
 #endif
   SaveLoadEncInfoSbt::destroy();
+#if FEATURE_TEST
+  if( m_dtBenchmarkReps > 0 )
+  {
+    m_dtBenchmark.print();
+  }
+  if( m_dtControl.isActive() )
+  {
+    m_dtControl.print( m_dtThresholds );
+  }
+  if( m_dtShadow )
+  {
+    m_dtShadowStats.print();
+  }
+  m_dtForest.reset();
+  m_dtDataset.reset();
+  m_dtTelemetry.reset();
+#endif
 }
 
-void EncModeCtrlMTnoRQT::initCTUEncoding( const Slice &slice )
+void EncModeCtrlMTnoRQT::initCTUEncoding( const Slice &slice, const unsigned ctuRsAddr )
 {
   CacheBlkInfoCtrl::init( slice );
 #if REUSE_CU_RESULTS
@@ -1118,6 +1186,14 @@ void EncModeCtrlMTnoRQT::initCTUEncoding( const Slice &slice )
 #if ENABLE_SPLIT_PARALLELISM
   m_runNextInParallel      = false;
 #endif
+#if FEATURE_TEST
+  m_dtCollectCtu      = m_dtDataset && m_dtSampling.samplePicture( slice.getPOC(), slice.getPic()->lheight() ) && m_dtSampling.sampleCtu( slice.getPOC(), ctuRsAddr );
+  m_dtFeatureCache.init();
+  if( m_dtControl.isActive() )
+  {
+    m_dtControl.update( m_dtThresholds );
+  }
+#endif
 
   if( m_pcEncCfg->getUseE0023FastEnc() )
   {
@@ -1147,7 +1223,7 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
     }
   }
 
-  m_ComprCUCtxList.push_back( ComprCUCtx( cs, minDepth, maxDepth, NUM_EXTRA_FEATURES ) );
+  m_ComprCUCtxList.reuse_back().init( cs, minDepth, maxDepth );
 
 #if ENABLE_SPLIT_PARALLELISM
   if( m_runNextInParallel )
@@ -1171,36 +1247,9 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
                          || ( !cuAbove && !cuLeft   && cs.area.lwidth() >= ( 32 << cs.slice->getDepth() ) ) )
                          && ( cs.area.lwidth() > ( cs.pcv->getMinQtSize( *cs.slice, partitioner.chType ) << 1 ) );
 
-  // set features
+  // set features, the others keep the initial values of ComprCUFeatures
   ComprCUCtx &cuECtx  = m_ComprCUCtxList.back();
-  cuECtx.set( BEST_NON_SPLIT_COST,  MAX_DOUBLE );
-  cuECtx.set( BEST_VERT_SPLIT_COST, MAX_DOUBLE );
-  cuECtx.set( BEST_HORZ_SPLIT_COST, MAX_DOUBLE );
-  cuECtx.set( BEST_TRIH_SPLIT_COST, MAX_DOUBLE );
-  cuECtx.set( BEST_TRIV_SPLIT_COST, MAX_DOUBLE );
-  cuECtx.set( DO_TRIH_SPLIT,        1 );
-  cuECtx.set( DO_TRIV_SPLIT,        1 );
-  cuECtx.set( BEST_IMV_COST,        MAX_DOUBLE * .5 );
-  cuECtx.set( BEST_NO_IMV_COST,     MAX_DOUBLE * .5 );
-  cuECtx.set( QT_BEFORE_BT,         qtBeforeBt );
-  cuECtx.set( DID_QUAD_SPLIT,       false );
-  cuECtx.set( IS_BEST_NOSPLIT_SKIP, false );
-  cuECtx.set( MAX_QT_SUB_DEPTH,     0 );
-#if  FEATURE_TEST
-  cuECtx.set(BEST_QT_COST, MAX_DOUBLE);
-  cuECtx.set(NO_SPLIT_FLAG, 2);
-  cuECtx.set(QT_FLAG, 2);
-  cuECtx.set(HOR_FLAG, 2);
-#endif
-#if DISABLE_RF_IF_EMPTY_CU_WHEN_FULL
-  cuECtx.set(EMPTY_CU_WHEN_FULL, false);
-#endif
-#if FEATURE_TEST
-  cuECtx.set(IS_NON_SPLIT_INTRA, false);
-  cuECtx.set(IS_NON_SPLIT_INTER, false);
-  cuECtx.set(IS_NON_SPLIT_MERGE, false);
-  cuECtx.set(IS_NON_SPLIT_GEO, false);
-#endif
+  cuECtx.features.qtBeforeBt = qtBeforeBt;
 
   // QP
   int baseQP = cs.baseQP;
@@ -1252,7 +1301,7 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
   //////////////////////////////////////////////////////////////////////////
   // Add unit split modes
 
-  if( !cuECtx.get<bool>( QT_BEFORE_BT ) )
+  if( !cuECtx.features.qtBeforeBt )
   {
     for( int qp = maxQP; qp >= minQP; qp-- )
     {
@@ -1288,11 +1337,11 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
     {
       m_ComprCUCtxList.back().testModes.push_back( { ETM_SPLIT_BT_V, ETO_STANDARD, qp } );
     }
-    m_ComprCUCtxList.back().set( DID_VERT_SPLIT, true );
+    m_ComprCUCtxList.back().features.didVertSplit = true;
   }
   else
   {
-    m_ComprCUCtxList.back().set( DID_VERT_SPLIT, false );
+    m_ComprCUCtxList.back().features.didVertSplit = false;
   }
 
   if( partitioner.canSplit( CU_HORZ_SPLIT, cs ) )
@@ -1302,14 +1351,14 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
     {
       m_ComprCUCtxList.back().testModes.push_back( { ETM_SPLIT_BT_H, ETO_STANDARD, qp } );
     }
-    m_ComprCUCtxList.back().set( DID_HORZ_SPLIT, true );
+    m_ComprCUCtxList.back().features.didHorzSplit = true;
   }
   else
   {
-    m_ComprCUCtxList.back().set( DID_HORZ_SPLIT, false );
+    m_ComprCUCtxList.back().features.didHorzSplit = false;
   }
 
-  if( cuECtx.get<bool>( QT_BEFORE_BT ) )
+  if( cuECtx.features.qtBeforeBt )
   {
     for( int qp = maxQPq; qp >= minQPq; qp-- )
     {
@@ -1344,9 +1393,9 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
 #if REUSE_CU_RESULTS
     const bool isReusingCu = isValid( cs, partitioner, qp );
 #if DISABLE_CU_CACHING
-	cuECtx.set(IS_REUSING_CU, false);
+	cuECtx.features.isReusingCu = false;
 #else
-    cuECtx.set( IS_REUSING_CU, isReusingCu );
+    cuECtx.features.isReusingCu = isReusingCu;
 #endif
     if( isReusingCu )
     {
@@ -1433,7 +1482,10 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
 
   // ensure to skip unprobable modes
 #if FEATURE_TEST
-  m_ComprCUCtxList.back().testModes.push_back({ IS_FIRST_MODE });
+  if( m_dtInfer || m_dtCollectCtu )
+  {
+    m_ComprCUCtxList.back().testModes.push_back({ IS_FIRST_MODE });
+  }
 #endif
   if( !tryModeMaster( m_ComprCUCtxList.back().testModes.back(), cs, partitioner ) )
   {
@@ -1445,348 +1497,799 @@ void EncModeCtrlMTnoRQT::initCULevel( Partitioner &partitioner, const CodingStru
 
 void EncModeCtrlMTnoRQT::finishCULevel( Partitioner &partitioner )
 {
+#if FEATURE_TEST
+  if( m_dtControl.isActive() )
+  {
+    xAuditDTDecisions( partitioner );
+  }
+  if( m_dtShadow )
+  {
+    xShadowDTDecisions( partitioner );
+  }
+#endif
   m_ComprCUCtxList.pop_back();
 }
 
 
-bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingStructure &cs, Partitioner& partitioner )
-{
-  ComprCUCtx& cuECtx = m_ComprCUCtxList.back();
-
 #if FEATURE_TEST
-  const CompArea& currArea = partitioner.currArea().Y();
-  int ht = currArea.height, wd = currArea.width;
+void EncModeCtrlMTnoRQT::xBenchmarkDTForest( const DTDecision decision, const int width, const int height, float* features )
+{
+  const DTForestEngine& engine       = m_dtForest->getEngine();
+  double                engineProb   = 0.0;
+  double                compiledProb = 0.0;
 
-  int sizeIndex = 28;
-  switch (wd)
+  const auto start = std::chrono::steady_clock::now();
+  for( int i = 0; i < m_dtBenchmarkReps; i++ )
   {
-  case 128:
-	  switch (ht)
-	  {
-	  case 128:
-		  sizeIndex = 27;
-		  break;
-	  case 64:
-		  sizeIndex = 26;
-		  break;
-	  }
-	  break;
-  case 64:
-	  switch (ht)
-	  {
-	  case 128:
-		  sizeIndex = 25;
-		  break;
-	  case 64:
-		  sizeIndex = 24;
-		  break;
-	  case 32:
-		  sizeIndex = 23;
-		  break;
-	  case 16:
-		  sizeIndex = 20;
-		  break;
-	  case 8:
-		  sizeIndex = 15;
-		  break;
-	  }
-	  break;
-  case 32:
-	  switch (ht)
-	  {
-	  case 64:
-		  sizeIndex = 22;
-		  break;
-	  case 32:
-		  sizeIndex = 21;
-		  break;
-	  case 16:
-		  sizeIndex = 18;
-		  break;
-	  case 8:
-		  sizeIndex = 13;
-		  break;
-	  }
-	  break;
-  case 16:
-	  switch (ht)
-	  {
-	  case 64:
-		  sizeIndex = 19;
-		  break;
-	  case 32:
-		  sizeIndex = 17;
-		  break;
-	  case 16:
-		  sizeIndex = 16;
-		  break;
-	  case 8:
-		  sizeIndex = 11;
-		  break;
-	  }
-	  break;
-  case 8:
-	  switch (ht)
-	  {
-	  case 64:
-		  sizeIndex = 14;
-		  break;
-	  case 32:
-		  sizeIndex = 12;
-		  break;
-	  case 16:
-		  sizeIndex = 10;
-		  break;
-	  case 8:
-		  sizeIndex = 9;
-		  break;
-	  }
-	  break;
+    engineProb += engine.predict( decision, width, height, features );
   }
-
-  if (encTestmode.type == ETM_POST_DONT_SPLIT)
+  const auto mid = std::chrono::steady_clock::now();
+  for( int i = 0; i < m_dtBenchmarkReps; i++ )
   {
+    compiledProb += decision == DT_DECISION_QT_MTT ? m_rf.predictQTMTT( features, width, height ) : m_rf.predictHorVer( features, width, height );
+  }
+  const auto end = std::chrono::steady_clock::now();
 
-#if COLLECT_DATASET
-    bool frame_collect =  ((cs.slice->getPOC() % 3 == 0) && (cs.slice->getPic()->lheight() == 544 || cs.slice->getPic()->lheight() == 272)) || ((cs.slice->getPic()->lheight() == 1088 || cs.slice->getPic()->lheight() == 2176 || cs.slice->getPic()->lheight() == 720) && (cs.slice->getPOC() == 8 || cs.slice->getPOC() == 16 || cs.slice->getPOC() == 28 || cs.slice->getPOC() == 42 || cs.slice->getPOC() == 49 || cs.slice->getPOC() == 57));
+  m_dtBenchmark.numCalls    [decision] += m_dtBenchmarkReps;
+  m_dtBenchmark.engineTime  [decision] += std::chrono::duration<double>( mid - start ).count();
+  m_dtBenchmark.compiledTime[decision] += std::chrono::duration<double>( end - mid ).count();
+  m_dtBenchmark.maxAbsDiff  [decision]  = std::max( m_dtBenchmark.maxAbsDiff[decision], std::abs( engineProb - compiledProb ) / m_dtBenchmarkReps );
+}
 
-    if (cs.slice->getSliceType() != I_SLICE && frame_collect && cs.treeType != TREE_C)
-#else
-    if (cs.slice->getSliceType() != I_SLICE && cs.treeType != TREE_C)
-#endif
-	  {
-		  if (sizeIndex == 28)
-			  return false;
 
-		  int qp = cs.baseQP;
+DTSplitCosts EncModeCtrlMTnoRQT::xGetDTSplitCosts( const ComprCUCtx& cuECtx ) const
+{
+  DTSplitCosts costs;
+  costs.noSplit = cuECtx.features.bestNonSplitCost;
+  costs.qt      = cuECtx.features.bestQtCost;
+  costs.btH     = cuECtx.features.bestHorzSplitCost;
+  costs.btV     = cuECtx.features.bestVertSplitCost;
+  costs.ttH     = cuECtx.features.bestTriHSplitCost;
+  costs.ttV     = cuECtx.features.bestTriVSplitCost;
+  return costs;
+}
 
-		  const CompArea& currArea = partitioner.currArea().Y();
-		  int ht = currArea.height,  wd = currArea.width;
-		  if ((ht + partitioner.currArea().Y().lumaPos().y >= cs.slice->getPic()->lheight()) || (wd + partitioner.currArea().Y().lumaPos().x >= cs.slice->getPic()->lwidth()))
-		  {
-			  return false;
-		  }
-		  const CPelBuf orgPel = cs.getOrgBuf(partitioner.currArea().block(COMPONENT_Y)); //cs.getOrgBuf(cs.area.blocks[COMPONENT_Y]);
-		  int halfW = max(wd / 2, 4), halfH = max(ht / 2, 4);
-		  double sum = 0, squaredSum = 0, totalSum = 0, totalSquaredSum = 0;
+/** Compares the best cost of the full search of an audited CU with the best cost of the modes its DT decisions would
+ *  have left, the difference is the RD cost lost by pruning the CU.
+ */
+void EncModeCtrlMTnoRQT::xAuditDTDecisions( const Partitioner& partitioner )
+{
+  const ComprCUCtx& cuECtx  = m_ComprCUCtxList.back();
+  const int         flag[5] = { cuECtx.features.dtAuditNoSplitFlag, cuECtx.features.dtAuditQtFlag, cuECtx.features.dtAuditHorFlag,
+                                cuECtx.features.dtAuditBtHorFlag, cuECtx.features.dtAuditBtVerFlag };
 
+  if( flag[0] == 2 && flag[1] == 2 && flag[2] == 2 && flag[3] == 2 && flag[4] == 2 )
+  {
+    return;
+  }
 
-		  for (int y = 0; y < halfH; y++)
-		  {
-			  for (int x = 0; x < halfW; x++)
-			  {
-				  const Pel* ptrOrg = orgPel.bufAt(x, y);
-				  sum += (int)* ptrOrg;  squaredSum += ((int)* ptrOrg) * ((int)* ptrOrg);
-			  }
-		  }
-		  double aveTopL = (double)sum / (double)(halfH * halfW);
-		  double varTopL = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveTopL * aveTopL);
-		  totalSum += sum;  totalSquaredSum += squaredSum;
-		  double _squaredSumPixTopL = squaredSum, _sumPixTopL = sum;
+  const DTSplitCosts costs   = xGetDTSplitCosts( cuECtx );
+  const double       best    = costs.best();
+  const int          width   = partitioner.currArea().lwidth();
+  const int          height  = partitioner.currArea().lheight();
+  const bool         isIntra = m_slice->isIntra();
 
-		  sum = 0, squaredSum = 0;
-		  for (int y = 0; y < halfH; y++)
-		  {
-			  for (int x = halfW; x < wd; x++)
-			  {
-				  const Pel* ptrOrg = orgPel.bufAt(x, y);
-				  sum += (int)* ptrOrg;  squaredSum += ((int)* ptrOrg) * ((int)* ptrOrg);
-			  }
-		  }
-		  double aveTopR = (double)sum / (double)(halfH * halfW);
-		  double varTopR = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveTopR * aveTopR);
-		  totalSum += sum;  totalSquaredSum += squaredSum;
-		  double _squaredSumPixTopR = squaredSum, _sumPixTopR = sum;
+  const DTDecision decision[5] = { DT_DECISION_INTRA_SPLIT, isIntra ? DT_DECISION_INTRA_QT_MTT : DT_DECISION_QT_MTT, isIntra ? DT_DECISION_INTRA_HOR_VER : DT_DECISION_HOR_VER,
+                                   DT_DECISION_BT_TT, DT_DECISION_BT_TT };
+  for( int s = DT_SLOT_NO_SPLIT; s <= DT_SLOT_BT_VER; s++ )
+  {
+    // the opposite of no split prunes nothing and is not audited
+    if( flag[s] == 2 || ( s == DT_SLOT_NO_SPLIT && flag[s] != 1 ) )
+    {
+      continue;
+    }
+    const double kept = costs.kept( DTCuSlot( s ), flag[s] );
+    if( kept < MAX_DOUBLE )
+    {
+      m_dtControl.addAudit( decision[s], width, height, kept - best, best );
+    }
+  }
+}
 
-		  sum = 0, squaredSum = 0;
-		  for (int y = halfH; y < ht; y++)
-		  {
-			  for (int x = 0; x < halfW; x++)
-			  {
-				  const Pel* ptrOrg = orgPel.bufAt(x, y);
-				  sum += (int)* ptrOrg;  squaredSum += ((int)* ptrOrg) * ((int)* ptrOrg);
-			  }
-		  }
-		  double aveBotL = (double)sum / (double)(halfH * halfW);
-		  double varBotL = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveBotL * aveBotL);
-		  totalSum += sum;  totalSquaredSum += squaredSum;
-		  double _squaredSumPixBotL = squaredSum, _sumPixBotL= sum;
+/** Shadow mode: evaluates the decisions the forests would have taken on a CU against its full search. Split decisions
+ *  are labelled with the best split costs and charged the RD cost their pruning would have lost; tool decisions are
+ *  labelled with the tools of the best non-split mode, the cost of leaving out a tool is not measured.
+ */
+void EncModeCtrlMTnoRQT::xShadowDTDecisions( const Partitioner& partitioner )
+{
+  const ComprCUCtx&  cuECtx = m_ComprCUCtxList.back();
+  const DTShadowCU&  shadow = cuECtx.dtShadow;
+  const DTSplitCosts costs  = xGetDTSplitCosts( cuECtx );
+  const double       best   = costs.best();
+  const int          width  = partitioner.currArea().lwidth();
+  const int          height = partitioner.currArea().lheight();
 
-		  sum = 0, squaredSum = 0;
-		  for (int y = halfH; y < ht; y++)
-		  {
-			  for (int x = halfW; x < wd; x++)
-			  {
-				  const Pel* ptrOrg = orgPel.bufAt(x, y);
-				  sum += (int)* ptrOrg;  squaredSum += ((int)* ptrOrg) * ((int)* ptrOrg);
-			  }
-		  }
-		  double aveBotR = (double)sum / (double)(halfH * halfW);
-		  double varBotR = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveBotR * aveBotR);
-		  totalSum += sum;  totalSquaredSum += squaredSum;
-		  double _squaredSumPixBotR = squaredSum, _sumPixBotR = sum;
+  for( int s = 0; s < NUM_DT_CU_SLOTS; s++ )
+  {
+    if( shadow.prob[s] < 0.0f )
+    {
+      continue;
+    }
+    if( s >= DT_SLOT_AFFINE )
+    {
+      if( shadow.toolFlags >= 0 )
+      {
+        const int trueClass = ( shadow.toolFlags >> ( s - DT_SLOT_AFFINE ) ) & 1;
+        m_dtShadowStats.add( shadow.decision[s], width, height, shadow.prob[s], shadow.flag[s], trueClass, 0.0, 0.0 );
+      }
+      continue;
+    }
 
-		  double ave = ((double)totalSum / (double)(ht * wd));                       //redundant
-		  double var = ((double)(totalSquaredSum) / (double)(ht * wd)) - (ave * ave);
+    const int trueClass = costs.trueClass( DTCuSlot( s ) );
+    if( trueClass < 0 )
+    {
+      continue;
+    }
+    const double loss = shadow.flag[s] != 2 ? costs.kept( DTCuSlot( s ), shadow.flag[s] ) - best : 0.0;
+    m_dtShadowStats.add( shadow.decision[s], width, height, shadow.prob[s], shadow.flag[s], trueClass, loss, best );
+  }
+}
 
-		  double gradHor = 0.0, gradVer = 0.0;
-		  double gradHorTopL = 0.0, gradVerTopL = 0.0;
-		  double sobel = 0.0;
-		  double sobelTopL = 0.0;
-		  for (int y = 0; y < halfH - 1; y++)
-		  {
-			  for (int x = 0; x < halfW - 1; x++)
-			  {
-				  gradHorTopL += abs(orgPel.at(x + 1, y) - orgPel.at(x, y));
-				  gradVerTopL += abs(orgPel.at(x, y + 1) - orgPel.at(x, y));
-				  if (x >= 1 && y >= 1)
-				  {
-					  double x_sum = (orgPel.at(x - 1, y + 1) + 2 * orgPel.at(x, y + 1) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x, y - 1) + orgPel.at(x + 1, y - 1));
-					  double y_sum = (orgPel.at(x + 1, y - 1) + 2 * orgPel.at(x + 1, y) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x - 1, y) + orgPel.at(x - 1, y + 1));
-					  sobelTopL += ((x_sum) * (x_sum)) + ((y_sum) * (y_sum));
-				  }
-			  }
-		  }
-		  sobel += sobelTopL;
-		  sobelTopL = sobelTopL / ((halfH - 2) * (halfW - 2));
-		  gradHor += gradHorTopL;   gradVer += gradVerTopL;
-		  gradHorTopL = gradHorTopL / ((halfH - 1) * (halfW - 1));
-		  gradVerTopL = gradVerTopL / ((halfH - 1) * (halfW - 1));
+/** Features of the BT/TT decision in one split direction. They compare the two halves of the binary split with the
+ *  three parts of the ternary split along the split axis, so unlike the quadrant features they are also defined for
+ *  4xN and Nx4 CUs. The CU has to lie inside the picture and both splits have to be possible, i.e. the CU is at least
+ *  16 samples long along the axis and every part covers whole 4x4 blocks of the motion field.
+ */
+void EncModeCtrlMTnoRQT::xGetBTTTFeatures( const CodingStructure& cs, const ComprCUCtx& cuECtx, const CompArea& area, const bool horSplit, float* features ) const
+{
+  const FeatureIntegrals* integrals = cs.slice->getPic()->getFeatureIntegrals();
+  const MotionField*      field     = cs.slice->getPic()->getMotionField();
+  CHECK( !integrals || !field, "Features of the current picture are not available" );
+
+  const int    len          = horSplit ? area.height : area.width;
+  const int    breadth      = horSplit ? area.width  : area.height;
+  const double widthFactor  = (double) cs.slice->getPic()->lwidth()  / 416.0;
+  const double heightFactor = (double) cs.slice->getPic()->lheight() / 240.0;
+
+  // part [off, off + size) along the split axis
+  auto getPart = [&]( const int off, const int size )
+  {
+    return horSplit ? Area( area.x, area.y + off, area.width, size ) : Area( area.x + off, area.y, size, area.height );
+  };
+  auto getVar = [&]( const Area& part )
+  {
+    const double num = (double) part.area();
+    const double ave = integrals->getSum( part.x, part.y, part.width, part.height ) / num;
+    return integrals->getSqSum( part.x, part.y, part.width, part.height ) / num - ave * ave;
+  };
+  // mean |gradient| across the line between the parts starting at off - 1 and off
+  auto getLineGrad = [&]( const int off )
+  {
+    return horSplit ? integrals->getGradVer( area.x, area.y + off - 1, area.width, 1 ) / (double) breadth
+                    : integrals->getGradHor( area.x + off - 1, area.y, 1, area.height ) / (double) breadth;
+  };
+  // mean SAD and scaled mean motion vector of the 4x4 blocks of a part
+  auto getMotion = [&]( const Area& part, double& sad, double& mvHor, double& mvVer )
+  {
+    double sumSAD = 0, sumX = 0, sumY = 0;
+    for( int by = part.y >> 2; by < ( part.y + part.height ) >> 2; by++ )
+    {
+      for( int bx = part.x >> 2; bx < ( part.x + part.width ) >> 2; bx++ )
+      {
+        const Mv mv = field->getMv( bx, by );
+        sumX   += mv.getHor();
+        sumY   += mv.getVer();
+        sumSAD += field->getSAD( bx, by );
+      }
+    }
+    const double num = (double) ( part.width >> 2 ) * ( part.height >> 2 );
+    sad   = sumSAD / num;
+    mvHor = sumX / num / widthFactor;
+    mvVer = sumY / num / heightFactor;
+  };
+
+  const Area bt[2] = { getPart( 0, len / 2 ), getPart( len / 2, len / 2 ) };
+  const Area tt[3] = { getPart( 0, len / 4 ), getPart( len / 4, len / 2 ), getPart( 3 * len / 4, len / 4 ) };
+
+  const double var     = getVar( area );
+  const double varBT[2] = { getVar( bt[0] ), getVar( bt[1] ) };
+  const double varTT[3] = { getVar( tt[0] ), getVar( tt[1] ), getVar( tt[2] ) };
+
+  const double gradPerp = horSplit ? integrals->getGradVer( area.x, area.y, area.width, area.height - 1 ) / (double) ( area.width * ( area.height - 1 ) )
+                                   : integrals->getGradHor( area.x, area.y, area.width - 1, area.height ) / (double) ( ( area.width - 1 ) * area.height );
+  const double gradPar  = horSplit ? integrals->getGradHor( area.x, area.y, area.width - 1, area.height ) / (double) ( ( area.width - 1 ) * area.height )
+                                   : integrals->getGradVer( area.x, area.y, area.width, area.height - 1 ) / (double) ( area.width * ( area.height - 1 ) );
+
+  double sad, mvHor, mvVer, sadBT[2], mvHorBT[2], mvVerBT[2], sadTT[3], mvHorTT[3], mvVerTT[3];
+  getMotion( area, sad, mvHor, mvVer );
+  for( int i = 0; i < 2; i++ )
+  {
+    getMotion( bt[i], sadBT[i], mvHorBT[i], mvVerBT[i] );
+  }
+  for( int i = 0; i < 3; i++ )
+  {
+    getMotion( tt[i], sadTT[i], mvHorTT[i], mvVerTT[i] );
+  }
+
+  bool isIntra = false, isMerge = false;
+  if( cuECtx.bestCS && !cuECtx.bestCS->cus.empty() )
+  {
+    const CodingUnit& bestCU = *cuECtx.bestCS->cus[0];
+    isIntra = CU::isIntra( bestCU );
+    isMerge = CU::isInter( bestCU ) && bestCU.firstPU->mergeFlag && !bestCU.geoFlag;
+  }
+
+  features[ 0] = (float) cs.slice->getPic()->temporalId;
+  features[ 1] = (float) cs.baseQP;
+  features[ 2] = (float) horSplit;
+  features[ 3] = (float) var;
+  features[ 4] = (float) varBT[0];
+  features[ 5] = (float) varBT[1];
+  features[ 6] = (float) varTT[0];
+  features[ 7] = (float) varTT[1];
+  features[ 8] = (float) varTT[2];
+  features[ 9] = (float) ( var / ( 1.0 + 0.5 * ( varBT[0] + varBT[1] ) ) );
+  features[10] = (float) ( var / ( 1.0 + 0.25 * ( varTT[0] + 2.0 * varTT[1] + varTT[2] ) ) );
+  features[11] = (float) gradPerp;
+  features[12] = (float) gradPar;
+  features[13] = (float) getLineGrad( len / 2 );
+  features[14] = (float) ( 0.5 * ( getLineGrad( len / 4 ) + getLineGrad( 3 * len / 4 ) ) );
+  features[15] = (float) sad;
+  features[16] = (float) std::abs( sadBT[0] - sadBT[1] );
+  features[17] = (float) std::abs( sadTT[1] - 0.5 * ( sadTT[0] + sadTT[2] ) );
+  features[18] = (float) ( std::abs( mvHorBT[0] - mvHorBT[1] ) + std::abs( mvVerBT[0] - mvVerBT[1] ) );
+  features[19] = (float) ( std::abs( mvHorTT[1] - 0.5 * ( mvHorTT[0] + mvHorTT[2] ) ) + std::abs( mvVerTT[1] - 0.5 * ( mvVerTT[0] + mvVerTT[2] ) ) );
+  features[20] = (float) isIntra;
+  features[21] = (float) isMerge;
+}
 
+/** BT/TT decision for each split direction left by the QT/MTT and Hor/Ver decisions in which both splits are possible.
+ *  There is no compiled-in classifier for it, so it is only predicted with a forest file.
+ */
+void EncModeCtrlMTnoRQT::xDecideBTTT( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx )
+{
+  const bool predict = m_dtInfer && m_dtForest;
 
-		  double gradHorTopR = 0.0, gradVerTopR = 0.0;
-		  double sobelTopR = 0.0;
-		  for (int y = 0; y < halfH - 1; y++)
-		  {
-			  for (int x = halfW; x < wd - 1; x++)
-			  {
-				  gradHorTopR += abs(orgPel.at(x + 1, y) - orgPel.at(x, y));
-				  gradVerTopR += abs(orgPel.at(x, y + 1) - orgPel.at(x, y));
-				  if (x >= 1 && y >= 1)
-				  {
-					  double x_sum = (orgPel.at(x - 1, y + 1) + 2 * orgPel.at(x, y + 1) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x, y - 1) + orgPel.at(x + 1, y - 1));
-					  double y_sum = (orgPel.at(x + 1, y - 1) + 2 * orgPel.at(x + 1, y) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x - 1, y) + orgPel.at(x - 1, y + 1));
-					  sobelTopR += ((x_sum) * (x_sum)) + ((y_sum) * (y_sum));
-				  }
-			  }
-		  }
-		  sobel += sobelTopR;
-		  sobelTopR = sobelTopR / ((halfH - 2) * (halfW - 2));
-		  gradHor += gradHorTopR;   gradVer += gradVerTopR;
-		  gradHorTopR = gradHorTopR / ((halfH - 1) * (halfW - 1));
-		  gradVerTopR = gradVerTopR / ((halfH - 1) * (halfW - 1));
+  if( ( !predict && !m_dtCollectCtu ) || cuECtx.features.qtFlag == 1 )
+  {
+    return;
+  }
 
+  const CompArea& area = partitioner.currArea().Y();
+  if( area.x + area.width > cs.slice->getPic()->lwidth() || area.y + area.height > cs.slice->getPic()->lheight() )
+  {
+    return;
+  }
 
-		  double gradHorBotL = 0.0, gradVerBotL = 0.0;
-		  double sobelBotL = 0.0;
-		  for (int y = halfH; y < ht - 1; y++)
-		  {
-			  for (int x = 0; x < halfW - 1; x++)
-			  {
-				  gradHorBotL += abs(orgPel.at(x + 1, y) - orgPel.at(x, y));
-				  gradVerBotL += abs(orgPel.at(x, y + 1) - orgPel.at(x, y));
-				  if (x >= 1 && y >= 1)
-				  {
-					  double x_sum = (orgPel.at(x - 1, y + 1) + 2 * orgPel.at(x, y + 1) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x, y - 1) + orgPel.at(x + 1, y - 1));
-					  double y_sum = (orgPel.at(x + 1, y - 1) + 2 * orgPel.at(x + 1, y) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x - 1, y) + orgPel.at(x - 1, y + 1));
-					  sobelBotL += ((x_sum) * (x_sum)) + ((y_sum) * (y_sum));
-				  }
-			  }
-		  }
-		  sobel += sobelBotL;
-		  sobelBotL = sobelBotL / ((halfH - 2) * (halfW - 2));
-		  gradHor += gradHorBotL;   gradVer += gradVerBotL;
-		  gradHorBotL = gradHorBotL / ((halfH - 1) * (halfW - 1));
-		  gradVerBotL = gradVerBotL / ((halfH - 1) * (halfW - 1));
+  const int tLayer  = cs.slice->getPic()->temporalId;
+  const int horFlag = cuECtx.features.horFlag;
 
+  for( int dir = 0; dir < 2; dir++ )
+  {
+    const bool horSplit = dir == 0;
 
-		  double sobelBotR = 0.0;
-		  double gradHorBotR = 0.0, gradVerBotR = 0.0;
-		  for (int y = halfH; y < ht - 1; y++)
-		  {
-			  for (int x = halfW; x < wd - 1; x++)
-			  {
-				  gradHorBotR += abs(orgPel.at(x + 1, y) - orgPel.at(x, y));
-				  gradVerBotR += abs(orgPel.at(x, y + 1) - orgPel.at(x, y));
-				  if (x >= 1 && y >= 1)
-				  {
-					  double x_sum = (orgPel.at(x - 1, y + 1) + 2 * orgPel.at(x, y + 1) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x, y - 1) + orgPel.at(x + 1, y - 1));
-					  double y_sum = (orgPel.at(x + 1, y - 1) + 2 * orgPel.at(x + 1, y) + orgPel.at(x + 1, y + 1))
-						  - (orgPel.at(x - 1, y - 1) + 2 * orgPel.at(x - 1, y) + orgPel.at(x - 1, y + 1));
-					  sobelBotR += ((x_sum) * (x_sum)) + ((y_sum) * (y_sum));
-				  }
-			  }
-		  }
-		  sobel += sobelBotR;
-		  sobelBotR = sobelBotR / ((halfH - 2) * (halfW - 2));
-		  gradHor += gradHorBotR;   gradVer += gradVerBotR;
-		  gradHorBotR = gradHorBotR / ((halfH - 1) * (halfW - 1));
-		  gradVerBotR = gradVerBotR / ((halfH - 1) * (halfW - 1));
+    if( horFlag == ( horSplit ? 0 : 1 )
+      || !partitioner.canSplit( horSplit ? CU_HORZ_SPLIT : CU_VERT_SPLIT, cs ) || !partitioner.canSplit( horSplit ? CU_TRIH_SPLIT : CU_TRIV_SPLIT, cs ) )
+    {
+      continue;
+    }
 
+    float features[DT_NUM_FEATURES[DT_DECISION_BT_TT]];
+    {
+      DTTelemetryTimer timer( m_dtTelemetry.get(), DTTelemetry::TIME_FEATURES, DT_DECISION_BT_TT, area.width, area.height );
+      xGetBTTTFeatures( cs, cuECtx, area, horSplit, features );
+    }
 
-		  for (int y = 0; y < ht - 1; y++)
-		  {
-			  gradHor += abs(orgPel.at(halfW , y) - orgPel.at(halfW - 1, y));
-			  if (y >= 1)
-			  {
-				  double x_sum = (orgPel.at(halfW - 1, y + 1) + 2 * orgPel.at(halfW, y + 1) + orgPel.at(halfW + 1, y + 1))
-					  - (orgPel.at(halfW - 1, y - 1) + 2 * orgPel.at(halfW, y - 1) + orgPel.at(halfW + 1, y - 1));
-				  double y_sum = (orgPel.at(halfW + 1, y - 1) + 2 * orgPel.at(halfW + 1, y) + orgPel.at(halfW + 1, y + 1))
-					  - (orgPel.at(halfW - 1, y - 1) + 2 * orgPel.at(halfW - 1, y) + orgPel.at(halfW - 1, y + 1));
-				  sobel += ((x_sum) * (x_sum)) + ((y_sum) * (y_sum));
-			  }
-		  }
-		  for (int x = 0; x < wd - 1; x++)
-		  {
-			  gradVer += abs(orgPel.at(x, halfH) - orgPel.at(x, halfH - 1));
-			  if (x >= 1)
-			  {
-				  double x_sum = (orgPel.at(x - 1, halfH + 1) + 2 * orgPel.at(x, halfH + 1) + orgPel.at(x + 1, halfH + 1))
-					  - (orgPel.at(x - 1, halfH - 1) + 2 * orgPel.at(x, halfH - 1) + orgPel.at(x + 1, halfH - 1));
-				  double y_sum = (orgPel.at(x + 1, halfH - 1) + 2 * orgPel.at(x + 1, halfH) + orgPel.at(x + 1, halfH + 1))
-					  - (orgPel.at(x - 1, halfH - 1) + 2 * orgPel.at(x - 1, halfH) + orgPel.at(x - 1, halfH + 1));
-				  sobel += ((x_sum) * (x_sum)) + ((y_sum) * (y_sum));
-			  }
-		  }
-		  gradHor = gradHor / ((ht - 1) * (wd - 1));
-		  gradVer = gradVer / ((ht - 1) * (wd - 1));
-		  sobel = sobel / ((ht - 2) * (wd - 2));
+    if( m_dtCollectCtu )
+    {
+      m_dtDataset->writeFeatures( DT_DECISION_BT_TT, cs.slice->getPOC(), area, partitioner.getSplitSeries(), features );
+    }
+    if( !predict )
+    {
+      continue;
+    }
 
-		  double gradRatio = gradHor / gradVer;
+    double btFrac = 0.5;
+    {
+      DTTelemetryTimer timer( m_dtTelemetry.get(), DTTelemetry::TIME_INFERENCE, DT_DECISION_BT_TT, area.width, area.height );
+      btFrac = 1 - m_dtForest->getEngine().predict( DT_DECISION_BT_TT, area.width, area.height, features );
+    }
+    cuECtx.dtSchedule.pBt[dir] = btFrac;
+    int          btFlag = DTThresholds::decide( btFrac, Clip3( 0.5f, 1.0f, m_dtThresholds.get( DT_DECISION_BT_TT, area.width, area.height, tLayer ) + m_dtThresholdOffset ) );
 
-		  //const CPelBuf refPel = cs.slice->getRefPic(REF_PIC_LIST_0, 0)->getRecoBuf(cs.area.blocks[COMPONENT_Y]);
-		  //int distScale = (cs.slice->getPOC() - cs.slice->getRefPic(REF_PIC_LIST_0, 0)->getPOC());
-		  Mv* mvArray = cs.slice->getPic()->getMvArray();  
-		  Mv* mvPtr;
-		  double sumX = 0, squaredSumX = 0, sumY = 0, squaredSumY = 0;
+    if( m_dtShadow )
+    {
+      cuECtx.dtShadow.set( horSplit ? DT_SLOT_BT_HOR : DT_SLOT_BT_VER, DT_DECISION_BT_TT, 1 - btFrac, btFlag );
+      btFlag = 2;
+    }
+    else if( m_dtControl.isActive() && m_dtControl.sampleAudit( DT_DECISION_BT_TT, area.width, area.height, btFlag != 2 ) )
+    {
+      ( horSplit ? cuECtx.features.dtAuditBtHorFlag : cuECtx.features.dtAuditBtVerFlag ) = btFlag;
+      btFlag = 2;
+    }
+    ( horSplit ? cuECtx.features.btHorFlag : cuECtx.features.btVerFlag ) = btFlag;
+    if( m_dtTelemetry )
+    {
+      m_dtTelemetry->addDecision( DT_DECISION_BT_TT, area.width, area.height, btFlag );
+    }
+  }
+}
 
-		  int mvX[32][32], mvY[32][32];
-		  int* sadArray = cs.slice->getPic()->getSADErr();
-		  int* sadPtr;
-		  int sadError[32][32];
-		  double sumSAD = 0, squaredSumSAD = 0;
-		  double squaredMul = 0;// mvMul = 0;
-		  int x_cor = currArea.lumaPos().x, y_cor = currArea.lumaPos().y, picWd = cs.slice->getPic()->lwidth(), picHt = cs.slice->getPic()->lheight();
+/** Features of the intra decisions: texture statistics of the CU and its quadrants from the integral images, the depth
+ *  of the CU and of its luma neighbours in the (dual) luma tree, and the best intra mode found without splitting.
+ *  The CU has to be at least 8x8 and lie inside the picture.
+ */
+void EncModeCtrlMTnoRQT::xGetIntraFeatures( const CodingStructure& cs, const Partitioner& partitioner, const ComprCUCtx& cuECtx, float* features ) const
+{
+  const FeatureIntegrals* integrals = cs.slice->getPic()->getFeatureIntegrals();
+  CHECK( !integrals, "Feature integrals of the current picture are not available" );
+
+  const CompArea& area  = partitioner.currArea().Y();
+  const int       halfW = area.width / 2, halfH = area.height / 2;
+
+  auto getVar = [&]( const int x, const int y, const int w, const int h )
+  {
+    const double num = (double) w * h;
+    const double ave = integrals->getSum( x, y, w, h ) / num;
+    return integrals->getSqSum( x, y, w, h ) / num - ave * ave;
+  };
+  auto getSobel = [&]( const int x, const int y, const int w, const int h )
+  {
+    return integrals->getSobel( x, y, w, h ) / ( (double) w * h );
+  };
+
+  const double var     = getVar( area.x, area.y, area.width, area.height );
+  const double varQ[4] = { getVar( area.x, area.y,         halfW, halfH ), getVar( area.x + halfW, area.y,         halfW, halfH ),
+                           getVar( area.x, area.y + halfH, halfW, halfH ), getVar( area.x + halfW, area.y + halfH, halfW, halfH ) };
+  const double varTop  = getVar( area.x,         area.y,         area.width, halfH );
+  const double varBot  = getVar( area.x,         area.y + halfH, area.width, halfH );
+  const double varLeft = getVar( area.x,         area.y,         halfW, area.height );
+  const double varRght = getVar( area.x + halfW, area.y,         halfW, area.height );
+  const double gradHor = integrals->getGradHor( area.x, area.y, area.width - 1, area.height ) / (double) ( ( area.width - 1 ) * area.height );
+  const double gradVer = integrals->getGradVer( area.x, area.y, area.width, area.height - 1 ) / (double) ( area.width * ( area.height - 1 ) );
+
+  // luma neighbours, log2 of their area relative to the current CU
+  const CodingUnit* cuLeft  = cs.getCU( area.pos().offset( -1, 0 ), CHANNEL_TYPE_LUMA );
+  const CodingUnit* cuAbove = cs.getCU( area.pos().offset( 0, -1 ), CHANNEL_TYPE_LUMA );
+  const int         log2Area = floorLog2( area.area() );
+
+  bool   isPlanarDC = false, isMip = false, isIsp = false;
+  double costPerSample = 0.0;
+  if( cuECtx.bestCS && !cuECtx.bestCS->cus.empty() && CU::isIntra( *cuECtx.bestCS->cus[0] ) )
+  {
+    const CodingUnit& bestCU = *cuECtx.bestCS->cus[0];
+    isMip         = bestCU.mipFlag;
+    isIsp         = bestCU.ispMode != NOT_INTRA_SUBPARTITIONS;
+    isPlanarDC    = !isMip && bestCU.firstPU->intraDir[CHANNEL_TYPE_LUMA] <= DC_IDX;
+    costPerSample = cuECtx.bestCS->cost / area.area();
+  }
+
+  features[ 0] = (float) cs.baseQP;
+  features[ 1] = (float) var;
+  features[ 2] = (float) gradHor;
+  features[ 3] = (float) gradVer;
+  features[ 4] = (float) ( gradHor / ( gradVer + 1.0 ) );
+  for( int i = 0; i < 4; i++ )
+  {
+    features[5 + i] = (float) varQ[i];
+  }
+  features[ 9] = (float) getSobel( area.x,         area.y,         halfW, halfH );
+  features[10] = (float) getSobel( area.x + halfW, area.y,         halfW, halfH );
+  features[11] = (float) getSobel( area.x,         area.y + halfH, halfW, halfH );
+  features[12] = (float) getSobel( area.x + halfW, area.y + halfH, halfW, halfH );
+  features[13] = (float) ( ( varLeft + 1.0 ) / ( varRght + 1.0 ) );
+  features[14] = (float) ( ( varTop  + 1.0 ) / ( varBot  + 1.0 ) );
+  features[15] = (float) std::abs( varTop - varBot );
+  features[16] = (float) std::abs( varLeft - varRght );
+  features[17] = (float) ( *std::max_element( varQ, varQ + 4 ) / ( *std::min_element( varQ, varQ + 4 ) + 1.0 ) );
+  features[18] = (float) ( var / ( 1.0 + 0.25 * ( varQ[0] + varQ[1] + varQ[2] + varQ[3] ) ) );
+  features[19] = (float) partitioner.currQtDepth;
+  features[20] = (float) partitioner.currMtDepth;
+  features[21] = (float) ( cuLeft  != nullptr );
+  features[22] = (float) ( cuAbove != nullptr );
+  features[23] = (float) ( cuLeft  ? floorLog2( cuLeft ->Y().area() ) - log2Area : 0 );
+  features[24] = (float) ( cuAbove ? floorLog2( cuAbove->Y().area() ) - log2Area : 0 );
+  features[25] = (float) ( CS::isDualITree( cs ) );
+  features[26] = (float) isPlanarDC;
+  features[27] = (float) isMip;
+  features[28] = (float) isIsp;
+  features[29] = (float) costPerSample;
+}
 
-		  for (int y = 0; y < ht; y = y + 4)
-		  {
-			  for (int x = 0; x < wd; x = x + 4)
-			  {
-				  mvPtr = mvArray + ((y_cor + y) / 4) * (picWd / 4) + ((x_cor + x) / 4);
-				  int bestX = (*mvPtr).getHor(), bestY = (*mvPtr).getVer();
+/** Intra counterpart of the inter split decisions: early termination of the split search, QT/MTT and Hor/Ver, all
+ *  taken on the same intra feature vector with their own forests, which are only read from a forest file.
+ */
+void EncModeCtrlMTnoRQT::xDecideIntraDT( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx )
+{
+  const CompArea& area = partitioner.currArea().Y();
+  if( area.width < 8 || area.height < 8 || area.x + area.width > cs.slice->getPic()->lwidth() || area.y + area.height > cs.slice->getPic()->lheight() )
+  {
+    return;
+  }
 
-				  sumX += bestX;  squaredSumX += (bestX * bestX);  sumY += bestY;  squaredSumY += (bestY * bestY);
+  const bool canQt    = partitioner.canSplit( CU_QUAD_SPLIT, cs );
+  const bool canHor   = partitioner.canSplit( CU_HORZ_SPLIT, cs ) || partitioner.canSplit( CU_TRIH_SPLIT, cs );
+  const bool canVer   = partitioner.canSplit( CU_VERT_SPLIT, cs ) || partitioner.canSplit( CU_TRIV_SPLIT, cs );
+  const bool decide[3] = { canQt || canHor || canVer, canQt && ( canHor || canVer ), canHor && canVer };
+  const DTDecision decision[3] = { DT_DECISION_INTRA_SPLIT, DT_DECISION_INTRA_QT_MTT, DT_DECISION_INTRA_HOR_VER };
+  int* const       flag    [3] = { &cuECtx.features.noSplitFlag, &cuECtx.features.qtFlag, &cuECtx.features.horFlag };
+  int* const       audit   [3] = { &cuECtx.features.dtAuditNoSplitFlag, &cuECtx.features.dtAuditQtFlag, &cuECtx.features.dtAuditHorFlag };
+  const DTCuSlot   slot    [3] = { DT_SLOT_NO_SPLIT, DT_SLOT_QT, DT_SLOT_HOR };
+
+  if( !decide[0] )
+  {
+    return;
+  }
+
+  float features[DT_NUM_FEATURES[DT_DECISION_INTRA_SPLIT]];
+  {
+    DTTelemetryTimer timer( m_dtTelemetry.get(), DTTelemetry::TIME_FEATURES, DT_DECISION_INTRA_SPLIT, area.width, area.height );
+    xGetIntraFeatures( cs, partitioner, cuECtx, features );
+  }
+
+  if( m_dtCollectCtu )
+  {
+    for( int d = 0; d < 3; d++ )
+    {
+      if( decide[d] )
+      {
+        m_dtDataset->writeFeatures( decision[d], cs.slice->getPOC(), area, partitioner.getSplitSeries(), features );
+      }
+    }
+    if( cuECtx.bestCS && !cuECtx.bestCS->cus.empty() )
+    {
+      m_dtDataset->writeCost( cs.slice->getPOC(), area, partitioner.getSplitSeries(), ETM_POST_DONT_SPLIT, cuECtx.bestCS->cost );
+    }
+  }
+  if( !m_dtInfer || !m_dtForest )
+  {
+    return;
+  }
+
+  // each decision is only taken if the previous one did not settle it: no split leaves nothing to decide, QT leaves no
+  // direction to choose
+  const int tLayer = cs.slice->getPic()->temporalId;
+  for( int d = 0; d < 3; d++ )
+  {
+    if( !decide[d] )
+    {
+      continue;
+    }
+
+    double frac = 0.5;
+    {
+      DTTelemetryTimer timer( m_dtTelemetry.get(), DTTelemetry::TIME_INFERENCE, decision[d], area.width, area.height );
+      frac = 1 - m_dtForest->getEngine().predict( decision[d], area.width, area.height, features );
+    }
+    if( d > 0 )
+    {
+      ( d == 1 ? cuECtx.dtSchedule.pQt : cuECtx.dtSchedule.pHor ) = frac;
+    }
+    int dtFlag = DTThresholds::decide( frac, Clip3( 0.5f, 1.0f, m_dtThresholds.get( decision[d], area.width, area.height, tLayer ) + m_dtThresholdOffset ) );
+
+    if( m_dtShadow )
+    {
+      cuECtx.dtShadow.set( slot[d], decision[d], 1 - frac, dtFlag );
+      dtFlag = 2;
+    }
+    else if( m_dtControl.isActive() && m_dtControl.sampleAudit( decision[d], area.width, area.height, dtFlag != 2 ) )
+    {
+      *audit[d] = dtFlag;
+      dtFlag = 2;
+    }
+    *flag[d] = dtFlag;
+    if( m_dtTelemetry )
+    {
+      m_dtTelemetry->addDecision( decision[d], area.width, area.height, dtFlag );
+    }
+
+    if( dtFlag == 1 )
+    {
+      break;
+    }
+  }
+}
+
+static DTSplitMode getDTSplitMode( const EncTestModeType type )
+{
+  switch( type )
+  {
+  case ETM_SPLIT_QT:   return DT_SPLIT_QT;
+  case ETM_SPLIT_BT_H: return DT_SPLIT_BT_HOR;
+  case ETM_SPLIT_BT_V: return DT_SPLIT_BT_VER;
+  case ETM_SPLIT_TT_H: return DT_SPLIT_TT_HOR;
+  case ETM_SPLIT_TT_V: return DT_SPLIT_TT_VER;
+  default:             THROW( "Not a split mode" );
+  }
+}
+
+/** Orders the split modes of a CU from the most to the least likely by the probabilities of its DT decisions, taken
+ *  when ETM_POST_DONT_SPLIT is tested. The split modes are the bottom of the mode stack, below ETM_POST_DONT_SPLIT, and
+ *  are tested from the top, so they are sorted by increasing probability; modes of equal probability, e.g. of several
+ *  QPs, keep their order. The fixed order is kept if QT against MTT was not predicted where both are possible.
+ */
+void EncModeCtrlMTnoRQT::xOrderDTSplits( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx ) const
+{
+  DTSplitSchedule& schedule = cuECtx.dtSchedule;
+  if( schedule.pQt < 0.0 && schedule.pHor < 0.0 && schedule.pBt[0] < 0.0 && schedule.pBt[1] < 0.0 )
+  {
+    return;
+  }
+
+  // a decision without a choice is settled by the allowed splits, so that it does not weigh on the order
+  const bool canQt  = partitioner.canSplit( CU_QUAD_SPLIT, cs );
+  const bool canBtH = partitioner.canSplit( CU_HORZ_SPLIT, cs );
+  const bool canBtV = partitioner.canSplit( CU_VERT_SPLIT, cs );
+  const bool canTtH = partitioner.canSplit( CU_TRIH_SPLIT, cs );
+  const bool canTtV = partitioner.canSplit( CU_TRIV_SPLIT, cs );
+  const bool canHor = canBtH || canTtH;
+  const bool canVer = canBtV || canTtV;
+
+  if( !canQt || !( canHor || canVer ) )
+  {
+    schedule.pQt = canQt ? 1.0 : 0.0;
+  }
+  else if( schedule.pQt < 0.0 )
+  {
+    return;
+  }
+  if( !canHor || !canVer )
+  {
+    schedule.pHor = canHor ? 1.0 : 0.0;
+  }
+  if( !canBtH || !canTtH )
+  {
+    schedule.pBt[0] = canBtH ? 1.0 : 0.0;
+  }
+  if( !canBtV || !canTtV )
+  {
+    schedule.pBt[1] = canBtV ? 1.0 : 0.0;
+  }
+
+  std::vector<EncTestMode>& testModes = cuECtx.testModes;
+  CHECK( testModes.empty() || testModes.back().type != ETM_POST_DONT_SPLIT, "The split modes are ordered when ETM_POST_DONT_SPLIT is tested" );
+
+  auto end   = testModes.end() - 1;
+  auto begin = end;
+  while( begin != testModes.begin() && isModeSplit( *( begin - 1 ) ) )
+  {
+    begin--;
+  }
+  std::stable_sort( begin, end, [&schedule]( const EncTestMode& a, const EncTestMode& b ) { return schedule.prob( getDTSplitMode( a.type ) ) < schedule.prob( getDTSplitMode( b.type ) ); } );
+  schedule.active = true;
+}
+
+/** Early termination of the ordered split modes: the remaining split modes of a CU, the one about to be tested
+ *  included, are skipped once the best cost found beats the expected cost of each of them. Nothing is terminated before
+ *  a split was tested, and audited CUs are searched in full.
+ */
+bool EncModeCtrlMTnoRQT::xTerminateDTSplits( ComprCUCtx& cuECtx ) const
+{
+  DTSplitSchedule& schedule = cuECtx.dtSchedule;
+  if( schedule.terminated )
+  {
+    return true;
+  }
+  if( !schedule.active || !cuECtx.bestCS
+    || cuECtx.features.dtAuditNoSplitFlag != 2 || cuECtx.features.dtAuditQtFlag != 2 || cuECtx.features.dtAuditHorFlag != 2
+    || cuECtx.features.dtAuditBtHorFlag != 2 || cuECtx.features.dtAuditBtVerFlag != 2 )
+  {
+    return false;
+  }
+
+  const DTSplitCosts costs    = xGetDTSplitCosts( cuECtx );
+  const double       bestCost = cuECtx.bestCS->cost;
+  for( const EncTestMode& mode : cuECtx.testModes )
+  {
+    if( !isModeSplit( mode ) )
+    {
+      continue;
+    }
+    const double expectedCost = schedule.expectedCost( getDTSplitMode( mode.type ), costs, m_dtSplitOrderMargin );
+    if( expectedCost == MAX_DOUBLE || bestCost >= expectedCost )
+    {
+      return false;
+    }
+  }
+
+  schedule.terminated = true;
+  return true;
+}
+
+/** Inter tool decisions: the subblock merge (ETM_AFFINE), GEO, CIIP and MMVD checks of a CU are skipped if the forest
+ *  of the tool predicts that the best non-split mode will not use it. They are taken once, before the first merge or
+ *  affine mode, on the Hor/Ver features of the modes tested so far, and are only predicted with a forest file.
+ */
+void EncModeCtrlMTnoRQT::xDecideInterTools( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx )
+{
+  cuECtx.features.dtToolsDecided = true;
+
+  const CompArea& area = partitioner.currArea().Y();
+  if( area.width < 8 || area.height < 8 || area.x + area.width >= cs.slice->getPic()->lwidth() || area.y + area.height >= cs.slice->getPic()->lheight() )
+  {
+    return;
+  }
+
+  const SPS&       sps         = *cs.sps;
+  const bool       enabled [4] = { sps.getUseAffine() || sps.getSbTMVPEnabledFlag(), sps.getUseGeo() && cs.slice->isInterB(), sps.getUseCiip(), sps.getUseMMVD() };
+  const DTDecision decision[4] = { DT_DECISION_AFFINE, DT_DECISION_GEO, DT_DECISION_CIIP, DT_DECISION_MMVD };
+  int* const       flag    [4] = { &cuECtx.features.affineFlag, &cuECtx.features.geoFlag, &cuECtx.features.ciipFlag, &cuECtx.features.mmvdFlag };
+
+  float qTMTTFeatures[DT_NUM_FEATURES[DT_DECISION_QT_MTT]];
+  float features     [DT_NUM_FEATURES[DT_DECISION_HOR_VER]];
+  bool  featuresValid = false;
+  {
+    DTTelemetryTimer timer( m_dtTelemetry.get(), DTTelemetry::TIME_FEATURES, DT_DECISION_AFFINE, area.width, area.height );
+    xGetInterFeatures( cs, partitioner, cuECtx, qTMTTFeatures, features, featuresValid );
+  }
+  if( !featuresValid )
+  {
+    return;
+  }
+
+  const bool predict = m_dtInfer && m_dtForest;
+  const int  tLayer  = cs.slice->getPic()->temporalId;
+  for( int d = 0; d < 4; d++ )
+  {
+    if( !enabled[d] )
+    {
+      continue;
+    }
+    if( m_dtCollectCtu )
+    {
+      m_dtDataset->writeFeatures( decision[d], cs.slice->getPOC(), area, partitioner.getSplitSeries(), features );
+    }
+    if( predict )
+    {
+      // the skipped checks cannot be audited against the split costs, so the tool decisions are never audited
+      double frac = 0.5;
+      {
+        DTTelemetryTimer timer( m_dtTelemetry.get(), DTTelemetry::TIME_INFERENCE, decision[d], area.width, area.height );
+        frac = 1 - m_dtForest->getEngine().predict( decision[d], area.width, area.height, features );
+      }
+      int dtFlag = DTThresholds::decide( frac, Clip3( 0.5f, 1.0f, m_dtThresholds.get( decision[d], area.width, area.height, tLayer ) + m_dtThresholdOffset ) );
+      if( m_dtShadow )
+      {
+        cuECtx.dtShadow.set( DTCuSlot( DT_SLOT_AFFINE + d ), decision[d], 1 - frac, dtFlag );
+        dtFlag = 2;
+      }
+      *flag[d] = dtFlag;
+      if( m_dtTelemetry )
+      {
+        m_dtTelemetry->addDecision( decision[d], area.width, area.height, dtFlag );
+        // the CIIP and MMVD candidates are skipped inside the regular merge check, ETM_AFFINE and ETM_MERGE_GEO in tryMode
+        if( dtFlag == 1 && ( decision[d] == DT_DECISION_CIIP || decision[d] == DT_DECISION_MMVD ) )
+        {
+          m_dtTelemetry->addSkipped( decision[d], area.width, area.height );
+        }
+      }
+    }
+  }
+}
+
+bool EncModeCtrlMTnoRQT::skipDTInterTool( const DTDecision decision ) const
+{
+  const ComprCUCtx& cuECtx = m_ComprCUCtxList.back();
+
+  switch( decision )
+  {
+  case DT_DECISION_AFFINE: return cuECtx.features.affineFlag == 1;
+  case DT_DECISION_GEO:    return cuECtx.features.geoFlag == 1;
+  case DT_DECISION_CIIP:   return cuECtx.features.ciipFlag == 1;
+  case DT_DECISION_MMVD:   return cuECtx.features.mmvdFlag == 1;
+  default:                 return false;
+  }
+}
+
+/** Quadrant features of the inter QT/MTT and Hor/Ver decisions that only depend on the CU area, the features of the best
+ *  non-split mode are left at zero. noZeroDenom is false if a ratio among the QT/MTT features has a zero denominator,
+ *  horVerValid is false if one among the Hor/Ver features has.
+ */
+void EncModeCtrlMTnoRQT::xComputeInterFeatures( const CodingStructure& cs, const Partitioner& partitioner, DTCachedFeatures& features ) const
+{
+		  int qp = cs.baseQP;
+
+		  const CompArea& currArea = partitioner.currArea().Y();
+		  int ht = currArea.height,  wd = currArea.width;
+
+		  const FeatureIntegrals* integrals = cs.slice->getPic()->getFeatureIntegrals();
+		  CHECK(!integrals, "Feature integrals of the current picture are not available");
+		  const int xPos = currArea.lumaPos().x, yPos = currArea.lumaPos().y;
+		  int halfW = max(wd / 2, 4), halfH = max(ht / 2, 4);
+		  double sum = 0, squaredSum = 0, totalSum = 0, totalSquaredSum = 0;
+
+		  // quadrant statistics are rectangle sums on the per-picture integral images, see FeatureIntegrals
+		  sum = integrals->getSum(xPos, yPos, halfW, halfH);  squaredSum = (double)integrals->getSqSum(xPos, yPos, halfW, halfH);
+		  double aveTopL = (double)sum / (double)(halfH * halfW);
+		  double varTopL = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveTopL * aveTopL);
+		  totalSum += sum;  totalSquaredSum += squaredSum;
+		  double _squaredSumPixTopL = squaredSum, _sumPixTopL = sum;
+
+		  sum = integrals->getSum(xPos + halfW, yPos, wd - halfW, halfH);  squaredSum = (double)integrals->getSqSum(xPos + halfW, yPos, wd - halfW, halfH);
+		  double aveTopR = (double)sum / (double)(halfH * halfW);
+		  double varTopR = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveTopR * aveTopR);
+		  totalSum += sum;  totalSquaredSum += squaredSum;
+		  double _squaredSumPixTopR = squaredSum, _sumPixTopR = sum;
+
+		  sum = integrals->getSum(xPos, yPos + halfH, halfW, ht - halfH);  squaredSum = (double)integrals->getSqSum(xPos, yPos + halfH, halfW, ht - halfH);
+		  double aveBotL = (double)sum / (double)(halfH * halfW);
+		  double varBotL = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveBotL * aveBotL);
+		  totalSum += sum;  totalSquaredSum += squaredSum;
+		  double _squaredSumPixBotL = squaredSum, _sumPixBotL= sum;
+
+		  sum = integrals->getSum(xPos + halfW, yPos + halfH, wd - halfW, ht - halfH);  squaredSum = (double)integrals->getSqSum(xPos + halfW, yPos + halfH, wd - halfW, ht - halfH);
+		  double aveBotR = (double)sum / (double)(halfH * halfW);
+		  double varBotR = ((double)(squaredSum) / (double)(halfH * halfW)) - (aveBotR * aveBotR);
+		  totalSum += sum;  totalSquaredSum += squaredSum;
+		  double _squaredSumPixBotR = squaredSum, _sumPixBotR = sum;
+
+		  double ave = ((double)totalSum / (double)(ht * wd));                       //redundant
+		  double var = ((double)(totalSquaredSum) / (double)(ht * wd)) - (ave * ave);
+
+		  // gradients of a quadrant stay inside it (last column / row excluded), Sobel centres additionally skip the block border
+		  double gradHor = 0.0, gradVer = 0.0;
+		  double sobel = 0.0;
+		  double gradHorTopL = integrals->getGradHor(xPos, yPos, halfW - 1, halfH - 1);
+		  double gradVerTopL = integrals->getGradVer(xPos, yPos, halfW - 1, halfH - 1);
+		  double sobelTopL = (double)integrals->getSobel(xPos + 1, yPos + 1, halfW - 2, halfH - 2);
+		  sobel += sobelTopL;
+		  sobelTopL = sobelTopL / ((halfH - 2) * (halfW - 2));
+		  gradHor += gradHorTopL;   gradVer += gradVerTopL;
+		  gradHorTopL = gradHorTopL / ((halfH - 1) * (halfW - 1));
+		  gradVerTopL = gradVerTopL / ((halfH - 1) * (halfW - 1));
+
+		  double gradHorTopR = integrals->getGradHor(xPos + halfW, yPos, wd - 1 - halfW, halfH - 1);
+		  double gradVerTopR = integrals->getGradVer(xPos + halfW, yPos, wd - 1 - halfW, halfH - 1);
+		  double sobelTopR = (double)integrals->getSobel(xPos + halfW, yPos + 1, wd - 1 - halfW, halfH - 2);
+		  sobel += sobelTopR;
+		  sobelTopR = sobelTopR / ((halfH - 2) * (halfW - 2));
+		  gradHor += gradHorTopR;   gradVer += gradVerTopR;
+		  gradHorTopR = gradHorTopR / ((halfH - 1) * (halfW - 1));
+		  gradVerTopR = gradVerTopR / ((halfH - 1) * (halfW - 1));
+
+		  double gradHorBotL = integrals->getGradHor(xPos, yPos + halfH, halfW - 1, ht - 1 - halfH);
+		  double gradVerBotL = integrals->getGradVer(xPos, yPos + halfH, halfW - 1, ht - 1 - halfH);
+		  double sobelBotL = (double)integrals->getSobel(xPos + 1, yPos + halfH, halfW - 2, ht - 1 - halfH);
+		  sobel += sobelBotL;
+		  sobelBotL = sobelBotL / ((halfH - 2) * (halfW - 2));
+		  gradHor += gradHorBotL;   gradVer += gradVerBotL;
+		  gradHorBotL = gradHorBotL / ((halfH - 1) * (halfW - 1));
+		  gradVerBotL = gradVerBotL / ((halfH - 1) * (halfW - 1));
+
+		  double gradHorBotR = integrals->getGradHor(xPos + halfW, yPos + halfH, wd - 1 - halfW, ht - 1 - halfH);
+		  double gradVerBotR = integrals->getGradVer(xPos + halfW, yPos + halfH, wd - 1 - halfW, ht - 1 - halfH);
+		  double sobelBotR = (double)integrals->getSobel(xPos + halfW, yPos + halfH, wd - 1 - halfW, ht - 1 - halfH);
+		  sobel += sobelBotR;
+		  sobelBotR = sobelBotR / ((halfH - 2) * (halfW - 2));
+		  gradHor += gradHorBotR;   gradVer += gradVerBotR;
+		  gradHorBotR = gradHorBotR / ((halfH - 1) * (halfW - 1));
+		  gradVerBotR = gradVerBotR / ((halfH - 1) * (halfW - 1));
+
+		  // the column and row crossing the quadrant boundaries
+		  gradHor += integrals->getGradHor(xPos + halfW - 1, yPos, 1, ht - 1);
+		  sobel += (double)integrals->getSobel(xPos + halfW, yPos + 1, 1, ht - 2);
+		  gradVer += integrals->getGradVer(xPos, yPos + halfH - 1, wd - 1, 1);
+		  sobel += (double)integrals->getSobel(xPos + 1, yPos + halfH, wd - 2, 1);
+
+		  gradHor = gradHor / ((ht - 1) * (wd - 1));
+		  gradVer = gradVer / ((ht - 1) * (wd - 1));
+		  sobel = sobel / ((ht - 2) * (wd - 2));
+
+		  double gradRatio = gradHor / gradVer;
+
+		  //const CPelBuf refPel = cs.slice->getRefPic(REF_PIC_LIST_0, 0)->getRecoBuf(cs.area.blocks[COMPONENT_Y]);
+		  //int distScale = (cs.slice->getPOC() - cs.slice->getRefPic(REF_PIC_LIST_0, 0)->getPOC());
+		  const MotionField* field = cs.slice->getPic()->getMotionField();
+		  double sumX = 0, squaredSumX = 0, sumY = 0, squaredSumY = 0;
+
+		  int mvX[32][32], mvY[32][32];
+		  int sadError[32][32];
+		  double sumSAD = 0, squaredSumSAD = 0;
+		  double squaredMul = 0;// mvMul = 0;
+		  int x_cor = currArea.lumaPos().x, y_cor = currArea.lumaPos().y, picWd = cs.slice->getPic()->lwidth(), picHt = cs.slice->getPic()->lheight();
+
+		  for (int y = 0; y < ht; y = y + 4)
+		  {
+			  for (int x = 0; x < wd; x = x + 4)
+			  {
+				  const int blkIdx = ((y_cor + y) / 4) * field->getNumBlkCols() + ((x_cor + x) / 4);
+				  const Mv mv = field->getMv(blkIdx);
+				  int bestX = mv.getHor(), bestY = mv.getVer();
+
+				  sumX += bestX;  squaredSumX += (bestX * bestX);  sumY += bestY;  squaredSumY += (bestY * bestY);
 				  mvX[y / 4][x / 4] = bestX;  mvY[y / 4][x / 4] = bestY;
 
-				  sadPtr = sadArray + ((y_cor + y) / 4) * (picWd / 4) + ((x_cor + x) / 4);
-				  int bestSAD = (*sadPtr);
+				  int bestSAD = field->getSAD(blkIdx);
 
 				  sumSAD += bestSAD;  squaredSumSAD += (bestSAD * bestSAD);
 				  sadError[y / 4][x / 4] = bestSAD;
@@ -1980,209 +2483,222 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
 
 		  double ratio2HVSobel = ratio2HSobel / ratio2VSobel;
 
-			const CodingStructure* bestCS = cuECtx.bestCS;
-			bool isInter = false, isMerge = false, isGeo = false, isIntra = false;
-			if (bestCS != NULL && !bestCS->cus.empty())
-			{
-				CodingUnit* bestnonSplitcu = bestCS->cus[0];
-				bool isIntra = CU::isIntra(*bestnonSplitcu);
-				cuECtx.set(IS_NON_SPLIT_INTRA, isIntra);
-				if (!isIntra)
-				{
-					isInter = CU::isInter(*bestnonSplitcu) && !bestnonSplitcu->firstPU->mergeFlag;
-					isMerge = CU::isInter(*bestnonSplitcu) && bestnonSplitcu->firstPU->mergeFlag && !bestnonSplitcu->geoFlag;
-					isGeo = CU::isInter(*bestnonSplitcu) && bestnonSplitcu->geoFlag;
-				}
-				else
-				{
-					isInter = false;
-					isMerge = false;
-					isGeo = false;
-				}
-			}
-
+			const bool isIntra = false, isInter = false, isMerge = false, isGeo = false;
 
-			int tLayer = cs.slice->getPic()->temporalId;
-			float qTMTTFeatures[34] = { (float)tLayer, (float)qp, (float)var, (float)gradHor, (float)gradVer, (float)gradRatio, (float)varTopL, (float)varTopR, (float)varBotL, (float)varBotR,
+			const float qTMTT[34] = { (float)cs.slice->getPic()->temporalId, (float)qp, (float)var, (float)gradHor, (float)gradVer, (float)gradRatio, (float)varTopL, (float)varTopR, (float)varBotL, (float)varBotR,
 											(float)VarMvScaled, (float)varMVTopLScaled, (float)varMVTopRScaled, (float)varMVBotLScaled, (float)varMVBotRScaled, (float)eigenDifference, (float)aveSAD, (float)varSAD, (float)varSADTopL, (float)varSADTopR, (float)varSADBotL, (float)varSADBotR, (float)sobelTopL, (float)sobelTopR, (float)sobelBotL, (float)sobelBotR, (float)ratio2HGrad, (float)ratio2VGrad, (float)ratio2HVarMVScaled, (float)ratio2VVarMVScaled, (float)ratio2HVVarMVScaled, (float)isIntra, (float)isInter, (float)isMerge };
 		
-			float horVerFeatures[45] = { (float)tLayer, (float)qp, (float)var, (float)gradHor, (float)gradVer, (float)gradRatio, (float)varTopL, (float)varTopR, (float)varBotL, (float)varBotR,
+			const float horVer[45] = { (float)cs.slice->getPic()->temporalId, (float)qp, (float)var, (float)gradHor, (float)gradVer, (float)gradRatio, (float)varTopL, (float)varTopR, (float)varBotL, (float)varBotR,
 											(float)VarMvScaled, (float)varMVTopLScaled, (float)varMVTopRScaled, (float)varMVBotLScaled, (float)varMVBotRScaled, (float)aveMVScaled, (float)aveMVTopLScaled, (float)aveMVTopRScaled, (float)aveMVBotLScaled, (float)aveMVBotRScaled, (float)aveSAD, (float)varSAD, (float)varSADTopL, (float)varSADTopR, (float)varSADBotL, (float)varSADBotR, (float)sobelTopL, (float)sobelTopR, (float)sobelBotL, (float)sobelBotR, (float)ratio2HVarPix, (float)ratio2VVarPix, (float)ratio2HGrad, (float)ratio2VGrad, (float)ratio2HVarMVScaled, (float)ratio2VVarMVScaled, (float)ratio2HaveSAD, (float)ratio2VaveSAD, (float)ratio2HSobel, (float)ratio2VSobel, (float)ratio2HVSobel, (float)isIntra, (float)isInter, (float)isMerge, (float)isGeo };
 
+			std::copy(qTMTT, qTMTT + DT_NUM_FEATURES[DT_DECISION_QT_MTT], features.qTMTT);
+			std::copy(horVer, horVer + DT_NUM_FEATURES[DT_DECISION_HOR_VER], features.horVer);
 
+  features.horVerValid = !( (aveMVTopRScaled + aveMVBotRScaled) == 0.0 || (aveMVBotLScaled + aveMVBotRScaled) == 0.0 || (aveSADTopR + aveSADBotR) == 0.0 || (aveSADBotL + aveSADBotR) == 0.0 || (sobelBotL + sobelBotR) == 0.0 || (sobelTopR + sobelBotR) == 0.0 || ratio2VSobel == 0.0 );
+  features.noZeroDenom = gradVerBotR != 0.0 && gradVerBotL != 0.0 && gradVerTopR != 0.0 && gradVerTopL != 0.0 && gradVer != 0.0;
+}
 
-		bool noZeroDenom =  gradVerBotR != 0.0 && gradVerBotL != 0.0 && gradVerTopR != 0.0 && gradVerTopL != 0.0 && gradVer != 0.0;
-		if (!noZeroDenom)
-		{
-			cuECtx.set(NO_SPLIT_FLAG, 2);
-			cuECtx.set(QT_FLAG, 2);
-			cuECtx.set(HOR_FLAG, 2);
-		}
-		else
-		{
-#if COLLECT_DATASET
-      std::string nameFile = filename_arg.substr(filename_arg.find_last_of("/\\") + 1);
-      std::string sTracingFile_feature = "split_features_" + nameFile.substr(0, nameFile.find_last_of(".")) + "_QP_" + to_string(qp_arg) + ".csv";
+/** Features of the inter QT/MTT and Hor/Ver decisions, also used by the inter tool decisions. The CU has to be at least
+ *  8x8 and lie inside the picture. The area features are taken from the per-CTU cache, only those of the best non-split
+ *  mode found so far are refreshed. Returns false if a ratio among the QT/MTT features has a zero denominator,
+ *  horVerValid is false if one among the Hor/Ver features has.
+ */
+bool EncModeCtrlMTnoRQT::xGetInterFeatures( const CodingStructure& cs, const Partitioner& partitioner, ComprCUCtx& cuECtx, float* qTMTTFeatures, float* horVerFeatures, bool& horVerValid )
+{
+  bool              cached   = false;
+  DTCachedFeatures& features = m_dtFeatureCache.get( partitioner.currArea().Y(), cs.baseQP, cached );
+  if( !cached )
+  {
+    xComputeInterFeatures( cs, partitioner, features );
+  }
 
-      std::string format_head = "%d;%d;%d;%d;%d;%ld;%d;";
-#else
-			RandomForestClassfier rf;
-#endif
-			double noSplitFrac = 0.5;
+  // isIntra stays zero: the forests were trained on features where it was never set
+  const CodingStructure* bestCS = cuECtx.bestCS;
+  bool isInter = false, isMerge = false, isGeo = false, isIntra = false;
+  if( bestCS != NULL && !bestCS->cus.empty() )
+  {
+    const CodingUnit* bestNonSplitCU = bestCS->cus[0];
+    cuECtx.features.isNonSplitIntra = CU::isIntra( *bestNonSplitCU );
+    if( !CU::isIntra( *bestNonSplitCU ) )
+    {
+      isInter = CU::isInter( *bestNonSplitCU ) && !bestNonSplitCU->firstPU->mergeFlag;
+      isMerge = CU::isInter( *bestNonSplitCU ) && bestNonSplitCU->firstPU->mergeFlag && !bestNonSplitCU->geoFlag;
+      isGeo   = CU::isInter( *bestNonSplitCU ) && bestNonSplitCU->geoFlag;
+    }
+  }
 
+  std::copy( features.qTMTT,  features.qTMTT  + DT_NUM_FEATURES[DT_DECISION_QT_MTT],  qTMTTFeatures );
+  std::copy( features.horVer, features.horVer + DT_NUM_FEATURES[DT_DECISION_HOR_VER], horVerFeatures );
+  qTMTTFeatures [31] = (float) isIntra;
+  qTMTTFeatures [32] = (float) isInter;
+  qTMTTFeatures [33] = (float) isMerge;
+  horVerFeatures[41] = (float) isIntra;
+  horVerFeatures[42] = (float) isInter;
+  horVerFeatures[43] = (float) isMerge;
+  horVerFeatures[44] = (float) isGeo;
+
+  horVerValid = features.horVerValid;
+  return features.noZeroDenom;
+}
 
-#if !RF_TH_CMD
-#if INTIALIZE_TO_0_5
-			int noSplitFlag = noSplitFrac > 0.50 ? 1 : (noSplitFrac < 0.50 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_75
-			int noSplitFlag = noSplitFrac > 0.75 ? 1 : (noSplitFrac < 0.25 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_85
-			int noSplitFlag = noSplitFrac > 0.85 ? 1 : (noSplitFrac < 0.15 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_1_00
-			int noSplitFlag = noSplitFrac > 0.975 ? 1 : (noSplitFrac < 0.025 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_90
-			int noSplitFlag = noSplitFrac > 0.90 ? 1 : (noSplitFrac < 0.10 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_95
-			int noSplitFlag = noSplitFrac > 0.95 ? 1 : (noSplitFrac < 0.05 ? 0 : 2);
 #endif
-#else
+bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingStructure &cs, Partitioner& partitioner )
+{
+  ComprCUCtx& cuECtx = m_ComprCUCtxList.back();
 
-        float thdt = m_pcEncCfg->getThresholdDT();
-        int noSplitFlag;
-        if (thdt == 1.0f)
-			    noSplitFlag = noSplitFrac > 0.975 ? 1 : (noSplitFrac < 0.025 ? 0 : 2);
-        else
-          noSplitFlag = noSplitFrac > thdt ? 1 : (noSplitFrac < (1-thdt) ? 0 : 2);
+#if FEATURE_TEST
+  if (encTestmode.type == ETM_POST_DONT_SPLIT)
+  {
 
-#endif
+    if (cs.slice->getSliceType() != I_SLICE && (m_dtInfer || m_dtCollectCtu) && cs.treeType != TREE_C)
+	  {
+		  const CompArea& currArea = partitioner.currArea().Y();
+		  int ht = currArea.height,  wd = currArea.width;
 
+		  // the QT/MTT and Hor/Ver features are taken on the quadrants of the CU, 4xN and Nx4 CUs only get the BT/TT decision
+		  if (wd >= 8 && ht >= 8 && ht + currArea.lumaPos().y < cs.slice->getPic()->lheight() && wd + currArea.lumaPos().x < cs.slice->getPic()->lwidth())
+		  {
+			float qTMTTFeatures[34], horVerFeatures[45];
+			bool horVerValid = false;
+			bool noZeroDenom = false;
+			{
+				DTTelemetryTimer timer(m_dtTelemetry.get(), DTTelemetry::TIME_FEATURES, DT_DECISION_QT_MTT, wd, ht);
+				noZeroDenom = xGetInterFeatures(cs, partitioner, cuECtx, qTMTTFeatures, horVerFeatures, horVerValid);
+			}
+			int tLayer = cs.slice->getPic()->temporalId;
 
 
 
+		if (!noZeroDenom)
+		{
+			cuECtx.features.noSplitFlag = 2;
+			cuECtx.features.qtFlag = 2;
+			cuECtx.features.horFlag = 2;
+		}
+		else
+		{
+			const DTForestEngine* dtEngine = m_dtForest ? &m_dtForest->getEngine() : nullptr;
+			double noSplitFrac = 0.5;
+
+        int noSplitFlag = DTThresholds::decide(noSplitFrac, m_pcEncCfg->getThresholdDT());
+
 			//int qTFlag = 2, horFlag = 2, btFlag = 2;
 			int qTFlag = 2, horFlag = 2;
-			cuECtx.set(NO_SPLIT_FLAG, noSplitFlag);
+			cuECtx.features.noSplitFlag = noSplitFlag;
 			if (noSplitFlag != 1)
 			{
-#if COLLECT_DATASET
+        // QT/MTT is only decided where both are possible, i.e. on square CUs of the QT
+        const bool qTDecision = partitioner.canSplit(CU_QUAD_SPLIT, cs) && (partitioner.canSplit(CU_HORZ_SPLIT, cs) || partitioner.canSplit(CU_VERT_SPLIT, cs));
         double qTFrac = 0.5;
-        if (wd == ht && wd != 8){
-          FILE* m_trace_file_f = fopen( sTracingFile_feature.c_str(), "a+" );
-          WriteFormatted_features(m_trace_file_f, format_head.c_str(), cs.slice->getPOC(), ht, wd, partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), 0);  
-          for(int i = 0; i < 34; i++){
-           WriteFormatted_features(m_trace_file_f, "%f;", qTMTTFeatures[i]);
+        bool qTPredicted = false;
+        if (m_dtInfer && qTDecision)
+        {
+          DTTelemetryTimer timer(m_dtTelemetry.get(), DTTelemetry::TIME_INFERENCE, DT_DECISION_QT_MTT, wd, ht);
+				  qTFrac = dtEngine ? (1 - dtEngine->predict(DT_DECISION_QT_MTT, wd, ht, qTMTTFeatures)) : (1 - m_rf.predictQTMTT(qTMTTFeatures, wd, ht));
+          qTPredicted = true;
+          cuECtx.dtSchedule.pQt = qTFrac;
+          if (m_dtBenchmarkReps > 0)
+          {
+            xBenchmarkDTForest(DT_DECISION_QT_MTT, wd, ht, qTMTTFeatures);
           }
-          WriteFormatted_features(m_trace_file_f, "\n");
-          fclose(m_trace_file_f);
         }
-#else
-				double qTFrac = (wd == ht) ? (1 - rf.predictQTMTT(qTMTTFeatures, wd, ht)) : 0.5;
-#endif
-
-
-#if !RF_TH_CMD
-
-#if PCA_BASED_THRESHOLDS
-				qTFlag = qTFrac > pcaThresholdQT ? 1 : (qTFrac < (1 - pcaThresholdQT) ? 0 : 2);
-#else
-#if INTIALIZE_TO_0_5
-				qTFlag = qTFrac > 0.50 ? 1 : (qTFrac < 0.50 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_75
-				qTFlag = qTFrac > 0.75 ? 1 : (qTFrac < 0.25 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_85
-				qTFlag = qTFrac > 0.85 ? 1 : (qTFrac < 0.15 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_1_00
-				qTFlag = qTFrac > 0.975 ? 1 : (qTFrac < 0.025 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_90
-				qTFlag = qTFrac > 0.90 ? 1 : (qTFrac < 0.10 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_95
-				qTFlag = qTFrac > 0.95 ? 1 : (qTFrac < 0.05 ? 0 : 2);
-#endif
-#endif
-
-#else
-
-        float thdt = m_pcEncCfg->getThresholdDT();
-        if (thdt == 1.0f)
-			    qTFlag = qTFrac > 0.975 ? 1 : (qTFrac < 0.025 ? 0 : 2);
-        else
-          qTFlag = qTFrac > thdt ? 1 : (qTFrac < (1-thdt) ? 0 : 2);
-
-#endif
-
-
+        if (m_dtCollectCtu && qTDecision){
+          m_dtDataset->writeFeatures(DT_DECISION_QT_MTT, cs.slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), qTMTTFeatures);
+        }
 
+        qTFlag = DTThresholds::decide(qTFrac, Clip3(0.5f, 1.0f, m_dtThresholds.get(DT_DECISION_QT_MTT, wd, ht, tLayer) + m_dtThresholdOffset));
+        if (qTPredicted && m_dtShadow)
+        {
+          cuECtx.dtShadow.set(DT_SLOT_QT, DT_DECISION_QT_MTT, 1 - qTFrac, qTFlag);
+          qTFlag = 2;
+        }
+        else if (qTPredicted && m_dtControl.isActive() && m_dtControl.sampleAudit(DT_DECISION_QT_MTT, wd, ht, qTFlag != 2))
+        {
+          // the CU is searched without pruning and the decision is checked in finishCULevel
+          cuECtx.features.dtAuditQtFlag = qTFlag;
+          qTFlag = 2;
+        }
 
-				cuECtx.set(QT_FLAG, qTFlag);
-				bool zeroDenom2 = (aveMVTopRScaled + aveMVBotRScaled) == 0.0 || (aveMVBotLScaled + aveMVBotRScaled) == 0.0 || (aveSADTopR + aveSADBotR) == 0.0 || (aveSADBotL + aveSADBotR) == 0.0 || (sobelBotL + sobelBotR) == 0.0 || (sobelTopR + sobelBotR) == 0.0 || ratio2VSobel == 0.0;
-				if (qTFlag != 1 && !zeroDenom2)
+				cuECtx.features.qtFlag = qTFlag;
+				if (qTPredicted && m_dtTelemetry)
+				{
+					m_dtTelemetry->addDecision(DT_DECISION_QT_MTT, wd, ht, qTFlag);
+				}
+				bool zeroDenom2 = !horVerValid;
+				const bool horVerDecision = (partitioner.canSplit(CU_HORZ_SPLIT, cs) || partitioner.canSplit(CU_TRIH_SPLIT, cs)) && (partitioner.canSplit(CU_VERT_SPLIT, cs) || partitioner.canSplit(CU_TRIV_SPLIT, cs));
+				if (qTFlag != 1 && !zeroDenom2 && horVerDecision)
 				{
 
-#if COLLECT_DATASET
-          FILE* m_trace_file_f = fopen( sTracingFile_feature.c_str(), "a+" );
           double horFrac = 0.5;
-          WriteFormatted_features(m_trace_file_f, format_head.c_str(), cs.slice->getPOC(), ht, wd, partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), 1);  
-          for(int i = 0; i < 45; i++){
-           WriteFormatted_features(m_trace_file_f, "%f;", horVerFeatures[i]);
+          if (m_dtInfer)
+          {
+            DTTelemetryTimer timer(m_dtTelemetry.get(), DTTelemetry::TIME_INFERENCE, DT_DECISION_HOR_VER, wd, ht);
+					  horFrac = dtEngine ? (1 - dtEngine->predict(DT_DECISION_HOR_VER, wd, ht, horVerFeatures)) : (1 - m_rf.predictHorVer(horVerFeatures, wd, ht));
+            cuECtx.dtSchedule.pHor = horFrac;
+            if (m_dtBenchmarkReps > 0)
+            {
+              xBenchmarkDTForest(DT_DECISION_HOR_VER, wd, ht, horVerFeatures);
+            }
+          }
+          if (m_dtCollectCtu)
+          {
+            m_dtDataset->writeFeatures(DT_DECISION_HOR_VER, cs.slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), horVerFeatures);
           }
-          WriteFormatted_features(m_trace_file_f, "\n");
-          fclose(m_trace_file_f);
-#else
-					double horFrac = 1 - rf.predictHorVer(horVerFeatures, wd, ht);
-#endif
-
-
-#if !RF_TH_CMD
-
-#if PCA_BASED_THRESHOLDS
-					horFlag = horFrac > pcaThresholdHor ? 1 : (horFrac < (1 - pcaThresholdHor) ? 0 : 2);;
-#else
-#if INTIALIZE_TO_0_5
-					horFlag = horFrac > 0.50 ? 1 : (horFrac < 0.50 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_75
-					horFlag = horFrac > 0.75 ? 1 : (horFrac < 0.25 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_85
-					horFlag = horFrac > 0.85 ? 1 : (horFrac < 0.15 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_1_00
-					horFlag = horFrac > 0.975 ? 1 : (horFrac < 0.025 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_90
-					horFlag = horFrac > 0.90 ? 1 : (horFrac < 0.10 ? 0 : 2);
-#endif
-#if INTIALIZE_TO_0_95
-					horFlag = horFrac > 0.95 ? 1 : (horFrac < 0.05 ? 0 : 2);
-#endif
-#endif
-
-#else
-
-        float thdt = m_pcEncCfg->getThresholdDT();
-        if (thdt == 1.0f)
-			    horFlag = horFrac > 0.975 ? 1 : (horFrac < 0.025 ? 0 : 2);
-        else
-          horFlag = horFrac > thdt ? 1 : (horFrac < (1-thdt) ? 0 : 2);
-
-#endif
 
+        horFlag = DTThresholds::decide(horFrac, Clip3(0.5f, 1.0f, m_dtThresholds.get(DT_DECISION_HOR_VER, wd, ht, tLayer) + m_dtThresholdOffset));
+        if (m_dtInfer && m_dtShadow)
+        {
+          cuECtx.dtShadow.set(DT_SLOT_HOR, DT_DECISION_HOR_VER, 1 - horFrac, horFlag);
+          horFlag = 2;
+        }
+        else if (m_dtInfer && m_dtControl.isActive() && m_dtControl.sampleAudit(DT_DECISION_HOR_VER, wd, ht, horFlag != 2))
+        {
+          cuECtx.features.dtAuditHorFlag = horFlag;
+          horFlag = 2;
+        }
 
-					cuECtx.set(HOR_FLAG, horFlag);
+					cuECtx.features.horFlag = horFlag;
+					if (m_dtTelemetry)
+					{
+						m_dtTelemetry->addDecision(DT_DECISION_HOR_VER, wd, ht, horFlag);
+					}
 				}
 			}
 		}
+		  }
+
+		  xDecideBTTT(cs, partitioner, cuECtx);
+
+      // the best non-split cost, with the inter tools it uses as the labels of the tool decisions
+      const CodingStructure* bestCS = cuECtx.bestCS;
+      if ((m_dtCollectCtu || m_dtShadow) && isLuma(partitioner.chType) && bestCS && !bestCS->cus.empty())
+      {
+        const CodingUnit&     cu    = *bestCS->cus[0];
+        const PredictionUnit& pu    = *cu.firstPU;
+        uint32_t              tools = 0;
+        if (CU::isInter(cu))
+        {
+          tools |= pu.mergeFlag && (cu.affine || pu.mergeType == MRG_TYPE_SUBPU_ATMVP) ? DT_TOOL_AFFINE : 0;
+          tools |= cu.geoFlag ? DT_TOOL_GEO : 0;
+          tools |= pu.ciipFlag ? DT_TOOL_CIIP : 0;
+          tools |= pu.mmvdMergeFlag ? DT_TOOL_MMVD : 0;
+        }
+        if (m_dtCollectCtu)
+        {
+          m_dtDataset->writeCost(cs.slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), ETM_POST_DONT_SPLIT, bestCS->cost, tools);
+        }
+        cuECtx.dtShadow.toolFlags = int(tools);
+      }
   }
+    else if (cs.slice->getSliceType() == I_SLICE && ((m_dtInfer && m_dtForest) || m_dtCollectCtu) && cs.treeType != TREE_C && isLuma(partitioner.chType))
+    {
+      xDecideIntraDT(cs, partitioner, cuECtx);
+    }
+
+    if (m_dtSplitOrder != DT_SPLIT_ORDER_OFF)
+    {
+      xOrderDTSplits(cs, partitioner, cuECtx);
+    }
 
 	  if (encTestmode.type != ETM_POST_DONT_SPLIT)
 	  return false;
@@ -2191,6 +2707,20 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
   {
 	return false;
   }
+
+  if ((encTestmode.type == ETM_AFFINE || encTestmode.type == ETM_MERGE_SKIP || encTestmode.type == ETM_MERGE_GEO) && !cuECtx.features.dtToolsDecided
+      && ((m_dtInfer && m_dtForest) || m_dtCollectCtu) && cs.treeType != TREE_C)
+  {
+    xDecideInterTools(cs, partitioner, cuECtx);
+  }
+  if ((encTestmode.type == ETM_AFFINE && cuECtx.features.affineFlag == 1) || (encTestmode.type == ETM_MERGE_GEO && cuECtx.features.geoFlag == 1))
+  {
+    if (m_dtTelemetry)
+    {
+      m_dtTelemetry->addSkipped(encTestmode.type == ETM_AFFINE ? DT_DECISION_AFFINE : DT_DECISION_GEO, partitioner.currArea().lwidth(), partitioner.currArea().lheight());
+    }
+    return false;
+  }
 #endif
 
 
@@ -2213,7 +2743,7 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
   if (encTestmode.type == ETM_POST_DONT_SPLIT)
   {
 	  const CodingStructure* bestCS = cuECtx.bestCS;
-	  cuECtx.set(EMPTY_CU_WHEN_FULL, (bestCS == NULL || (bestCS != NULL && bestCS->cus.empty())) ? true : false);
+	  cuECtx.features.emptyCuWhenFull = (bestCS == NULL || (bestCS != NULL && bestCS->cus.empty())) ? true : false;
   }
 #endif
 
@@ -2221,67 +2751,116 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
 #if FEATURE_TEST 
 
 #if DISABLE_RF_IF_EMPTY_CU_WHEN_FULL
-	  if(!cuECtx.get<bool>(EMPTY_CU_WHEN_FULL))
+	  if(!cuECtx.features.emptyCuWhenFull)
 	  {
 #endif
-		  if (cs.slice->getSliceType() != I_SLICE && sizeIndex != 28)
+		  if (m_dtInfer)
 		  {
-			  //int noSplitFlag = cuECtx.get<int>(NO_SPLIT_FLAG);
-			  int qTFlag = cuECtx.get<int>(QT_FLAG);
-			  int horFlag = cuECtx.get<int>(HOR_FLAG);
-			  //noSplitFlag = 2;
+			  int noSplitFlag = cuECtx.features.noSplitFlag;
+			  int qTFlag = cuECtx.features.qtFlag;
+			  int horFlag = cuECtx.features.horFlag;
+
+			  // the split modes skipped by a decision are counted for the telemetry, in intra slices by the intra decisions
+			  const bool isIntraSlice = cs.slice->isIntra();
+			  auto countSkipped = [&](const DTDecision decision)
+			  {
+				  if (m_dtTelemetry)
+				  {
+					  m_dtTelemetry->addSkipped(decision, partitioner.currArea().lwidth(), partitioner.currArea().lheight());
+				  }
+			  };
+
+			  // only the intra decisions terminate the split search
+			  if (noSplitFlag == 1 && isModeSplit(encTestmode))
+			  {
+				  cuECtx.features.didHorzSplit = false;
+				  cuECtx.features.didVertSplit = false;
+				  cuECtx.features.doTriHSplit = false;
+				  cuECtx.features.doTriVSplit = false;
+				  countSkipped(DT_DECISION_INTRA_SPLIT);
+				  return false;
+			  }
 
 #if MORE_RESTRICTIVE_SKIP
-			  if (qTFlag == 1 && encTestmode.type != ETM_SPLIT_QT && isModeSplit(encTestmode) && cuECtx.get<bool>(DID_QUAD_SPLIT))
+			  if (qTFlag == 1 && encTestmode.type != ETM_SPLIT_QT && isModeSplit(encTestmode) && cuECtx.features.didQuadSplit)
 #else
 			  if (qTFlag == 1 && encTestmode.type != ETM_SPLIT_QT && isModeSplit(encTestmode))
 #endif
 			  {
 				  {
-					  cuECtx.set(DID_HORZ_SPLIT, false);
-					  cuECtx.set(DID_VERT_SPLIT, false);
-					  cuECtx.set(DO_TRIH_SPLIT, false);
-					  cuECtx.set(DO_TRIV_SPLIT, false);
+					  cuECtx.features.didHorzSplit = false;
+					  cuECtx.features.didVertSplit = false;
+					  cuECtx.features.doTriHSplit = false;
+					  cuECtx.features.doTriVSplit = false;
+					  countSkipped(isIntraSlice ? DT_DECISION_INTRA_QT_MTT : DT_DECISION_QT_MTT);
 					  return false;
 				  }
 			  }
 #if MORE_RESTRICTIVE_SKIP
-			  if (qTFlag == 0 && isModeSplit(encTestmode) && (cuECtx.get<bool>(DID_HORZ_SPLIT) || cuECtx.get<bool>(DID_VERT_SPLIT) || cuECtx.get<bool>(DO_TRIH_SPLIT) || cuECtx.get<bool>(DO_TRIV_SPLIT)))
+			  if (qTFlag == 0 && isModeSplit(encTestmode) && (cuECtx.features.didHorzSplit || cuECtx.features.didVertSplit || cuECtx.features.doTriHSplit || cuECtx.features.doTriVSplit))
 #else
 			  if (!qTFlag && isModeSplit(encTestmode))
 #endif
 			  {
 				  if (encTestmode.type == ETM_SPLIT_QT)
 				  {
-					  cuECtx.set(DID_QUAD_SPLIT, false);
+					  cuECtx.features.didQuadSplit = false;
+					  countSkipped(isIntraSlice ? DT_DECISION_INTRA_QT_MTT : DT_DECISION_QT_MTT);
 					  return false;
 				  }
 			  }
 #if MORE_RESTRICTIVE_SKIP
-			  if (horFlag == 1 && (encTestmode.type == ETM_SPLIT_BT_V || encTestmode.type == ETM_SPLIT_TT_V) && (cuECtx.get<bool>(DID_HORZ_SPLIT) || cuECtx.get<bool>(DO_TRIH_SPLIT)))
+			  if (horFlag == 1 && (encTestmode.type == ETM_SPLIT_BT_V || encTestmode.type == ETM_SPLIT_TT_V) && (cuECtx.features.didHorzSplit || cuECtx.features.doTriHSplit))
 #else
 			  if (horFlag == 1 && (encTestmode.type == ETM_SPLIT_BT_V || encTestmode.type == ETM_SPLIT_TT_V))
 #endif
 			  {
 				  {
-					  cuECtx.set(DID_VERT_SPLIT, false);
-					  cuECtx.set(DO_TRIV_SPLIT, false);
+					  cuECtx.features.didVertSplit = false;
+					  cuECtx.features.doTriVSplit = false;
+					  countSkipped(isIntraSlice ? DT_DECISION_INTRA_HOR_VER : DT_DECISION_HOR_VER);
 					  return false;
 				  }
 			  }
 #if MORE_RESTRICTIVE_SKIP
-			  if (horFlag == 0 && (encTestmode.type == ETM_SPLIT_BT_H || encTestmode.type == ETM_SPLIT_TT_H) && (cuECtx.get<bool>(DID_VERT_SPLIT) || cuECtx.get<bool>(DO_TRIV_SPLIT)))
+			  if (horFlag == 0 && (encTestmode.type == ETM_SPLIT_BT_H || encTestmode.type == ETM_SPLIT_TT_H) && (cuECtx.features.didVertSplit || cuECtx.features.doTriVSplit))
 #else
 			  if (!horFlag && (encTestmode.type == ETM_SPLIT_BT_H || encTestmode.type == ETM_SPLIT_TT_H))
 #endif
 			  {
 				  //if (!(isBoundary && getPartSplit(encTestmode) == implicitSplit))
 				  {
-					  cuECtx.set(DID_HORZ_SPLIT, false);
-					  cuECtx.set(DO_TRIH_SPLIT, false);
+					  cuECtx.features.didHorzSplit = false;
+					  cuECtx.features.doTriHSplit = false;
+					  countSkipped(isIntraSlice ? DT_DECISION_INTRA_HOR_VER : DT_DECISION_HOR_VER);
 					  return false;
 				  }
 			  }
+
+			  // BT/TT: a skipped BT split must not keep the TT split from being tested, see CU_TRIH_SPLIT / CU_TRIV_SPLIT below
+			  const int btHorFlag = cuECtx.features.btHorFlag;
+			  const int btVerFlag = cuECtx.features.btVerFlag;
+			  if ((btHorFlag == 1 && encTestmode.type == ETM_SPLIT_TT_H) || (btVerFlag == 1 && encTestmode.type == ETM_SPLIT_TT_V))
+			  {
+				  (encTestmode.type == ETM_SPLIT_TT_H ? cuECtx.features.doTriHSplit : cuECtx.features.doTriVSplit) = false;
+				  countSkipped(DT_DECISION_BT_TT);
+				  return false;
+			  }
+			  if ((btHorFlag == 0 && encTestmode.type == ETM_SPLIT_BT_H) || (btVerFlag == 0 && encTestmode.type == ETM_SPLIT_BT_V))
+			  {
+				  (encTestmode.type == ETM_SPLIT_BT_H ? cuECtx.features.didHorzSplit : cuECtx.features.didVertSplit) = false;
+				  countSkipped(DT_DECISION_BT_TT);
+				  return false;
+			  }
+
+			  if (m_dtSplitOrder == DT_SPLIT_ORDER_TERMINATE && isModeSplit(encTestmode) && xTerminateDTSplits(cuECtx))
+			  {
+				  cuECtx.features.didHorzSplit = false;
+				  cuECtx.features.didVertSplit = false;
+				  cuECtx.features.doTriHSplit = false;
+				  cuECtx.features.doTriVSplit = false;
+				  return false;
+			  }
 		  }
 #if DISABLE_RF_IF_EMPTY_CU_WHEN_FULL
 	  }
@@ -2300,7 +2879,7 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
   }
 
 #if REUSE_CU_RESULTS
-  if( cuECtx.get<bool>( IS_REUSING_CU ) )
+  if( cuECtx.features.isReusingCu )
   {
     if( encTestmode.type == ETM_RECO_CACHED )
     {
@@ -2338,7 +2917,7 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
   if( bestCS && bestCS->cus.size() == 1 )
   {
     // update the best non-split cost
-    cuECtx.set( BEST_NON_SPLIT_COST, bestCS->cost );
+    cuECtx.features.bestNonSplitCost = bestCS->cost;
   }
 
   if( encTestmode.type == ETM_INTRA )
@@ -2488,7 +3067,7 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
       {
         int imvOpt = (encTestmode.opts & ETO_IMV) >> ETO_IMV_SHIFT;
 
-        if (imvOpt == 3 && cuECtx.get<double>(BEST_NO_IMV_COST) * 1.06 < cuECtx.get<double>(BEST_IMV_COST))
+        if (imvOpt == 3 && cuECtx.features.bestNoImvCost * 1.06 < cuECtx.features.bestImvCost)
         {
           if ( !m_pcEncCfg->getUseAffineAmvr() )
           return false;
@@ -2517,11 +3096,11 @@ bool EncModeCtrlMTnoRQT::tryMode( const EncTestMode& encTestmode, const CodingSt
     //////////////////////////////////////////////////////////////////////////
     int skipScore = 0;
 
-    if ((!slice.isIntra() || slice.getSPS()->getIBCFlag()) && cuECtx.get<bool>(IS_BEST_NOSPLIT_SKIP))
+    if ((!slice.isIntra() || slice.getSPS()->getIBCFlag()) && cuECtx.features.isBestNoSplitSkip)
     {
       for( int i = 2; i < m_ComprCUCtxList.size(); i++ )
       {
-        if( ( m_ComprCUCtxList.end() - i )->get<bool>( IS_BEST_NOSPLIT_SKIP ) )
+        if( ( m_ComprCUCtxList.end() - i )->features.isBestNoSplitSkip )
         {
           skipScore += 1;
         }
@@ -2561,9 +3140,9 @@ const CompArea& currArea = partitioner.currArea().Y();
 
     if( !partitioner.canSplit( split, cs ) || skipScore >= 2 )
     {
-      if( split == CU_HORZ_SPLIT ) cuECtx.set( DID_HORZ_SPLIT, false );
-      if( split == CU_VERT_SPLIT ) cuECtx.set( DID_VERT_SPLIT, false );
-      if( split == CU_QUAD_SPLIT ) cuECtx.set( DID_QUAD_SPLIT, false );
+      if( split == CU_HORZ_SPLIT ) cuECtx.features.didHorzSplit = false;
+      if( split == CU_VERT_SPLIT ) cuECtx.features.didVertSplit = false;
+      if( split == CU_QUAD_SPLIT ) cuECtx.features.didQuadSplit = false;
 
       return false;
     }
@@ -2623,7 +3202,7 @@ const CompArea& currArea = partitioner.currArea().Y();
       return false;
     }
 
-    int featureToSet = -1;
+    bool* featureToSet = nullptr;
 
     switch( getPartSplit( encTestmode ) )
     {
@@ -2632,7 +3211,7 @@ const CompArea& currArea = partitioner.currArea().Y();
 #if ENABLE_SPLIT_PARALLELISM
           if( !cuECtx.isLevelSplitParallel )
 #endif
-          if( !cuECtx.get<bool>( QT_BEFORE_BT ) && bestCU )
+          if( !cuECtx.features.qtBeforeBt && bestCU )
           {
             unsigned maxBTD        = cs.pcv->getMaxBtDepth( slice, partitioner.chType );
             const CodingUnit *cuBR = bestCS->cus.back();
@@ -2641,7 +3220,7 @@ const CompArea& currArea = partitioner.currArea().Y();
             if (bestCU && ((bestCU->btDepth == 0 && maxBTD >= ((slice.isIntra() && !slice.getSPS()->getIBCFlag()) ? 3 : 2))
               || (bestCU->btDepth == 1 && cuBR && cuBR->btDepth == 1 && maxBTD >= ((slice.isIntra() && !slice.getSPS()->getIBCFlag()) ? 4 : 3)))
               && (width <= MAX_TB_SIZEY && height <= MAX_TB_SIZEY)
-              && cuECtx.get<bool>(DID_HORZ_SPLIT) && cuECtx.get<bool>(DID_VERT_SPLIT))
+              && cuECtx.features.didHorzSplit && cuECtx.features.didVertSplit)
             {
               return false;
             }
@@ -2657,29 +3236,29 @@ const CompArea& currArea = partitioner.currArea().Y();
         }
         break;
       case CU_HORZ_SPLIT:
-        featureToSet = DID_HORZ_SPLIT;
+        featureToSet = &cuECtx.features.didHorzSplit;
         break;
       case CU_VERT_SPLIT:
-        featureToSet = DID_VERT_SPLIT;
+        featureToSet = &cuECtx.features.didVertSplit;
         break;
       case CU_TRIH_SPLIT:
-        if( cuECtx.get<bool>( DID_HORZ_SPLIT ) && bestCU && bestCU->btDepth == partitioner.currBtDepth && !bestCU->rootCbf )
+        if( cuECtx.features.didHorzSplit && bestCU && bestCU->btDepth == partitioner.currBtDepth && !bestCU->rootCbf )
         {
           return false;
         }
 
-        if( !cuECtx.get<bool>( DO_TRIH_SPLIT ) )
+        if( !cuECtx.features.doTriHSplit )
         {
           return false;
         }
         break;
       case CU_TRIV_SPLIT:
-        if( cuECtx.get<bool>( DID_VERT_SPLIT ) && bestCU && bestCU->btDepth == partitioner.currBtDepth && !bestCU->rootCbf )
+        if( cuECtx.features.didVertSplit && bestCU && bestCU->btDepth == partitioner.currBtDepth && !bestCU->rootCbf )
         {
           return false;
         }
 
-        if( !cuECtx.get<bool>( DO_TRIV_SPLIT ) )
+        if( !cuECtx.features.doTriVSplit )
         {
           return false;
         }
@@ -2694,22 +3273,22 @@ const CompArea& currArea = partitioner.currArea().Y();
     {
       case CU_HORZ_SPLIT:
       case CU_TRIH_SPLIT:
-        if( cuECtx.get<bool>( QT_BEFORE_BT ) && cuECtx.get<bool>( DID_QUAD_SPLIT ) )
+        if( cuECtx.features.qtBeforeBt && cuECtx.features.didQuadSplit )
         {
-          if( cuECtx.get<int>( MAX_QT_SUB_DEPTH ) > partitioner.currQtDepth + 1 )
+          if( cuECtx.features.maxQtSubDepth > partitioner.currQtDepth + 1 )
           {
-            if( featureToSet >= 0 ) cuECtx.set( featureToSet, false );
+            if( featureToSet ) *featureToSet = false;
             return false;
           }
         }
         break;
       case CU_VERT_SPLIT:
       case CU_TRIV_SPLIT:
-        if( cuECtx.get<bool>( QT_BEFORE_BT ) && cuECtx.get<bool>( DID_QUAD_SPLIT ) )
+        if( cuECtx.features.qtBeforeBt && cuECtx.features.didQuadSplit )
         {
-          if( cuECtx.get<int>( MAX_QT_SUB_DEPTH ) > partitioner.currQtDepth + 1 )
+          if( cuECtx.features.maxQtSubDepth > partitioner.currQtDepth + 1 )
           {
-            if( featureToSet >= 0 ) cuECtx.set( featureToSet, false );
+            if( featureToSet ) *featureToSet = false;
             return false;
           }
         }
@@ -2718,7 +3297,7 @@ const CompArea& currArea = partitioner.currArea().Y();
         break;
     }
 
-    if( split == CU_QUAD_SPLIT ) cuECtx.set( DID_QUAD_SPLIT, true );
+    if( split == CU_QUAD_SPLIT ) cuECtx.features.didQuadSplit = true;
     if (cs.sps->getLog2ParallelMergeLevelMinus2())
     {
       const CompArea& area = partitioner.currArea().Y();
@@ -2736,7 +3315,7 @@ const CompArea& currArea = partitioner.currArea().Y();
   else
   {
     CHECK( encTestmode.type != ETM_POST_DONT_SPLIT, "Unknown mode" );
-    if ((cuECtx.get<double>(BEST_NO_IMV_COST) == (MAX_DOUBLE * .5) || cuECtx.get<bool>(IS_REUSING_CU)) && !slice.isIntra())
+    if ((cuECtx.features.bestNoImvCost == (MAX_DOUBLE * .5) || cuECtx.features.isReusingCu) && !slice.isIntra())
     {
       unsigned idx1, idx2, idx3, idx4;
       getAreaIdx(partitioner.currArea().Y(), *slice.getPPS()->pcv, idx1, idx2, idx3, idx4);
@@ -2860,7 +3439,7 @@ const CompArea& currArea = partitioner.currArea().Y();
 #endif
         CacheBlkInfoCtrl::touch(partitioner.currArea());
 #endif
-        cuECtx.set( IS_BEST_NOSPLIT_SKIP, bestCU->skip );
+        cuECtx.features.isBestNoSplitSkip = bestCU->skip;
       }
     }
 
@@ -2896,78 +3475,54 @@ bool EncModeCtrlMTnoRQT::useModeResult( const EncTestMode& encTestmode, CodingSt
 
   //if ((poc == 12) && (height = 16) && (width == 8) && (pos_x == 244) && (pos_y == 16) && (split_s ==164897))
   //  int d = 2;
-#if COLLECT_DATASET
-      std::string nameFile = filename_arg.substr(filename_arg.find_last_of("/\\") + 1);
-      std::string sTracingFile_cost = "split_cost_" + nameFile.substr(0, nameFile.find_last_of(".")) + "_QP_" + to_string(qp_arg) + ".csv";
-
-      std::string format_head = "%d;%d;%d;%d;%d;%ld;%d;%.1f;";
-
-      bool frame_collect =  ((tempCS->slice->getPOC() % 3 == 0) && (tempCS->slice->getPic()->lheight() == 544 || tempCS->slice->getPic()->lheight() == 272)) || ((tempCS->slice->getPic()->lheight() == 1088 || tempCS->slice->getPic()->lheight() == 2176 || tempCS->slice->getPic()->lheight() == 720) && (tempCS->slice->getPOC() == 8 || tempCS->slice->getPOC() == 16 || tempCS->slice->getPOC() == 28 || tempCS->slice->getPOC() == 42 || tempCS->slice->getPOC() == 49 || tempCS->slice->getPOC() == 57));
-
-#endif
 
 
   if(      encTestmode.type == ETM_SPLIT_BT_H )
   {
-#if COLLECT_DATASET
-    if (tempCS->slice->getSliceType() != I_SLICE && frame_collect && tempCS->treeType != TREE_C){
-    FILE* m_trace_file_c = fopen( sTracingFile_cost.c_str(), "a+" );
-    WriteFormatted_features(m_trace_file_c, format_head.c_str(), tempCS->slice->getPOC(), partitioner.currArea().lheight(), partitioner.currArea().lwidth(), partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);  
-    WriteFormatted_features(m_trace_file_c, "\n"); 
-    fclose(m_trace_file_c);
+#if FEATURE_TEST
+    if (m_dtCollectCtu && tempCS->treeType != TREE_C && isLuma(partitioner.chType)){
+      m_dtDataset->writeCost(tempCS->slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);
     }
-#endif   
-     cuECtx.set( BEST_HORZ_SPLIT_COST, tempCS->cost );
+#endif
+     cuECtx.features.bestHorzSplitCost = tempCS->cost;
   }
   else if( encTestmode.type == ETM_SPLIT_BT_V )
   {
-#if COLLECT_DATASET
-    if (tempCS->slice->getSliceType() != I_SLICE && frame_collect && tempCS->treeType != TREE_C){
-    FILE* m_trace_file_c = fopen( sTracingFile_cost.c_str(), "a+" );
-    WriteFormatted_features(m_trace_file_c, format_head.c_str(), tempCS->slice->getPOC(), partitioner.currArea().lheight(), partitioner.currArea().lwidth(), partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);  
-    WriteFormatted_features(m_trace_file_c, "\n");
-    fclose(m_trace_file_c);
+#if FEATURE_TEST
+    if (m_dtCollectCtu && tempCS->treeType != TREE_C && isLuma(partitioner.chType)){
+      m_dtDataset->writeCost(tempCS->slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);
     }
-#endif 
-    cuECtx.set( BEST_VERT_SPLIT_COST, tempCS->cost );
+#endif
+    cuECtx.features.bestVertSplitCost = tempCS->cost;
   }
 #if  FEATURE_TEST
   else if (encTestmode.type == ETM_SPLIT_QT)
   {
-#if COLLECT_DATASET
-    if (tempCS->slice->getSliceType() != I_SLICE && frame_collect && tempCS->treeType != TREE_C){
-    FILE* m_trace_file_c = fopen( sTracingFile_cost.c_str(), "a+" );
-    WriteFormatted_features(m_trace_file_c, format_head.c_str(), tempCS->slice->getPOC(), partitioner.currArea().lheight(), partitioner.currArea().lwidth(), partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);  
-    WriteFormatted_features(m_trace_file_c, "\n");
-    fclose(m_trace_file_c);
+#if FEATURE_TEST
+    if (m_dtCollectCtu && tempCS->treeType != TREE_C && isLuma(partitioner.chType)){
+      m_dtDataset->writeCost(tempCS->slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);
     }
-#endif 
-	  cuECtx.set(BEST_QT_COST, tempCS->cost);
+#endif
+	  cuECtx.features.bestQtCost = tempCS->cost;
   }
 #endif
   else if( encTestmode.type == ETM_SPLIT_TT_H )
   {
-#if COLLECT_DATASET
-    if (tempCS->slice->getSliceType() != I_SLICE && frame_collect && tempCS->treeType != TREE_C){
-    FILE* m_trace_file_c = fopen( sTracingFile_cost.c_str(), "a+" );
-    WriteFormatted_features(m_trace_file_c, format_head.c_str(), tempCS->slice->getPOC(), partitioner.currArea().lheight(), partitioner.currArea().lwidth(), partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);  
-    WriteFormatted_features(m_trace_file_c, "\n");
-    fclose(m_trace_file_c);
+#if FEATURE_TEST
+    if (m_dtCollectCtu && tempCS->treeType != TREE_C && isLuma(partitioner.chType)){
+      m_dtDataset->writeCost(tempCS->slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);
     }
-#endif 
-    cuECtx.set( BEST_TRIH_SPLIT_COST, tempCS->cost );
+#endif
+    cuECtx.features.bestTriHSplitCost = tempCS->cost;
   }
   else if( encTestmode.type == ETM_SPLIT_TT_V )
   {
-#if COLLECT_DATASET
-    if (tempCS->slice->getSliceType() != I_SLICE && frame_collect && tempCS->treeType != TREE_C){
-    FILE* m_trace_file_c = fopen( sTracingFile_cost.c_str(), "a+" );
-    WriteFormatted_features(m_trace_file_c, format_head.c_str(), tempCS->slice->getPOC(), partitioner.currArea().lheight(), partitioner.currArea().lwidth(), partitioner.currArea().lx(), partitioner.currArea().ly(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);  
-    WriteFormatted_features(m_trace_file_c, "\n");
-    fclose(m_trace_file_c);
+#if FEATURE_TEST
+    if (m_dtCollectCtu && tempCS->treeType != TREE_C && isLuma(partitioner.chType)){
+      m_dtDataset->writeCost(tempCS->slice->getPOC(), partitioner.currArea().Y(), partitioner.getSplitSeries(), encTestmode.type, tempCS->cost);
     }
-#endif 
-    cuECtx.set( BEST_TRIV_SPLIT_COST, tempCS->cost );
+#endif
+    cuECtx.features.bestTriVSplitCost = tempCS->cost;
   }
   else if( encTestmode.type == ETM_INTRA )
   {
@@ -2989,16 +3544,16 @@ bool EncModeCtrlMTnoRQT::useModeResult( const EncTestMode& encTestmode, CodingSt
 
     if( imvMode == 1 )
     {
-      if( tempCS->cost < cuECtx.get<double>( BEST_IMV_COST ) )
+      if( tempCS->cost < cuECtx.features.bestImvCost )
       {
-        cuECtx.set( BEST_IMV_COST, tempCS->cost );
+        cuECtx.features.bestImvCost = tempCS->cost;
       }
     }
     else if( imvMode == 0 )
     {
-      if( tempCS->cost < cuECtx.get<double>( BEST_NO_IMV_COST ) )
+      if( tempCS->cost < cuECtx.features.bestNoImvCost )
       {
-        cuECtx.set( BEST_NO_IMV_COST, tempCS->cost );
+        cuECtx.features.bestNoImvCost = tempCS->cost;
       }
     }
   }
@@ -3010,7 +3565,7 @@ bool EncModeCtrlMTnoRQT::useModeResult( const EncTestMode& encTestmode, CodingSt
     {
       maxQtD = std::max<int>( maxQtD, cu->qtDepth );
     }
-    cuECtx.set( MAX_QT_SUB_DEPTH, maxQtD );
+    cuECtx.features.maxQtSubDepth = maxQtD;
   }
 
   int maxMtD = tempCS->pcv->getMaxBtDepth( *tempCS->slice, partitioner.chType ) + partitioner.currImplicitBtDepth;
@@ -3023,7 +3578,7 @@ bool EncModeCtrlMTnoRQT::useModeResult( const EncTestMode& encTestmode, CodingSt
       int cu1_h = tempCS->cus.front()->blocks[partitioner.chType].height;
       int cu2_h = tempCS->cus.back() ->blocks[partitioner.chType].height;
 
-      cuECtx.set( DO_TRIH_SPLIT, cu1_h < h_2 || cu2_h < h_2 || partitioner.currMtDepth + 1 == maxMtD );
+      cuECtx.features.doTriHSplit = cu1_h < h_2 || cu2_h < h_2 || partitioner.currMtDepth + 1 == maxMtD;
     }
   }
   else if( encTestmode.type == ETM_SPLIT_BT_V )
@@ -3034,7 +3589,7 @@ bool EncModeCtrlMTnoRQT::useModeResult( const EncTestMode& encTestmode, CodingSt
       int cu1_w = tempCS->cus.front()->blocks[partitioner.chType].width;
       int cu2_w = tempCS->cus.back() ->blocks[partitioner.chType].width;
 
-      cuECtx.set( DO_TRIV_SPLIT, cu1_w < w_2 || cu2_w < w_2 || partitioner.currMtDepth + 1 == maxMtD );
+      cuECtx.features.doTriVSplit = cu1_w < w_2 || cu2_w < w_2 || partitioner.currMtDepth + 1 == maxMtD;
     }
   }
 
@@ -3074,6 +3629,9 @@ void EncModeCtrlMTnoRQT::copyState( const EncModeCtrl& other, const UnitArea& ar
   this->SaveLoadEncInfoSbt ::copyState( *pOther );
 
   m_skipThreshold = pOther->m_skipThreshold;
+#if FEATURE_TEST
+  m_dtFeatureCache.init();
+#endif
 }
 
 int EncModeCtrlMTnoRQT::getNumParallelJobs( const CodingStructure &cs, Partitioner& partitioner ) const
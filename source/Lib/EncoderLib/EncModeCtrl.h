@@ -45,7 +45,6 @@
 #include "CommonLib/CodingStructure.h"
 #include "InterSearch.h"
 
-#include <typeinfo>
 #include <vector>
 
 #if FEATURE_TEST
@@ -53,8 +52,14 @@
 #include <fstream>
 #endif
 
-#if FEATURE_TEST && !COLLECT_DATASET
+#if FEATURE_TEST
 #include "rfTrain.h"
+#include "DTForest.h"
+#include "DTDataset.h"
+#include "DTThresholds.h"
+#include "DTTelemetry.h"
+#include "DTShadow.h"
+#include "DTSplitSchedule.h"
 #endif
 
 //////////////////////////////////////////////////////////////////////////
@@ -181,64 +186,105 @@ inline EncTestMode getCSEncMode( const CodingStructure& cs )
 // EncModeCtrl controls if specific modes should be tested
 //////////////////////////////////////////////////////////////////////////
 
+/// features of a CU gathered while its modes are tested, read by the fast mode decisions of EncModeCtrlMTnoRQT; the
+/// initial values are the ones of a CU before any mode is tested
+struct ComprCUFeatures
+{
+  bool     didHorzSplit       = false;
+  bool     didVertSplit       = false;
+  bool     didQuadSplit       = false;
+  double   bestHorzSplitCost  = MAX_DOUBLE;
+  double   bestVertSplitCost  = MAX_DOUBLE;
+  double   bestTriHSplitCost  = MAX_DOUBLE;
+  double   bestTriVSplitCost  = MAX_DOUBLE;
+  bool     doTriHSplit        = true;
+  bool     doTriVSplit        = true;
+  double   bestNonSplitCost   = MAX_DOUBLE;
+  double   bestNoImvCost      = MAX_DOUBLE * .5;
+  double   bestImvCost        = MAX_DOUBLE * .5;
+  bool     qtBeforeBt         = false;
+  bool     isBestNoSplitSkip  = false;
+  int      maxQtSubDepth      = 0;
+#if REUSE_CU_RESULTS
+  bool     isReusingCu        = false;
+#endif
+#if FEATURE_TEST
+  double   bestQtCost         = MAX_DOUBLE;
+  int      noSplitFlag        = 2;
+  int      qtFlag             = 2;
+  int      horFlag            = 2;
+  int      btHorFlag          = 2;       ///< BT/TT decision per split direction: 1 binary, 0 ternary, 2 undecided
+  int      btVerFlag          = 2;
+  int      dtAuditNoSplitFlag = 2;      ///< decisions of an audited CU, which is searched without pruning
+  int      dtAuditQtFlag      = 2;
+  int      dtAuditHorFlag     = 2;
+  int      dtAuditBtHorFlag   = 2;
+  int      dtAuditBtVerFlag   = 2;
+  int      affineFlag         = 2;       ///< inter tool decisions: 1 skip the tool, 0 keep it, 2 undecided
+  int      geoFlag            = 2;
+  int      ciipFlag           = 2;
+  int      mmvdFlag           = 2;
+  bool     dtToolsDecided     = false;   ///< the tool decisions are taken once, before the first merge or affine mode
+#endif
+#if DISABLE_RF_IF_EMPTY_CU_WHEN_FULL
+  bool     emptyCuWhenFull    = false;
+#endif
+#if FEATURE_TEST
+  bool     isNonSplitInter    = false;
+  bool     isNonSplitMerge    = false;
+  bool     isNonSplitIntra    = false;
+  bool     isNonSplitGeo      = false;
+#endif
+};
+
+/// context of a CU level, the contexts are pooled in EncModeCtrl::m_ComprCUCtxList and reinitialized by init() for
+/// each CU, so that the mode list keeps its memory
 struct ComprCUCtx
 {
-  ComprCUCtx() : testModes(), extraFeatures()
+  ComprCUCtx() : testModes()
   {
   }
 
-  ComprCUCtx( const CodingStructure& cs, const uint32_t _minDepth, const uint32_t _maxDepth, const uint32_t numExtraFeatures )
-    : minDepth      ( _minDepth  )
-    , maxDepth      ( _maxDepth  )
-    , testModes     (            )
-    , lastTestMode  (            )
-    , earlySkip     ( false      )
-    , isHashPerfectMatch
-                    ( false      )
-    , bestCS        ( nullptr    )
-    , bestCU        ( nullptr    )
-    , bestTU        ( nullptr    )
-    , extraFeatures (            )
-    , extraFeaturesd(            )
-    , bestInterCost ( MAX_DOUBLE )
-    , bestMtsSize2Nx2N1stPass
-                    ( MAX_DOUBLE )
-    , skipSecondMTSPass
-                    ( false )
-    , interHad      (std::numeric_limits<Distortion>::max())
-#if ENABLE_SPLIT_PARALLELISM
-    , isLevelSplitParallel
-                    ( false )
-#endif
-    , bestCostWithoutSplitFlags( MAX_DOUBLE )
-    , bestCostMtsFirstPassNoIsp( MAX_DOUBLE )
-    , bestCostIsp   ( MAX_DOUBLE )
-    , ispWasTested  ( false )
-    , bestPredModeDCT2
-                    ( UINT8_MAX )
-    , relatedCuIsValid
-                    ( false )
-    , ispPredModeVal( 0 )
-    , bestDCT2NonISPCost
-                    ( MAX_DOUBLE )
-    , bestNonDCT2Cost
-                    ( MAX_DOUBLE )
-    , bestISPIntraMode
-                    ( UINT8_MAX )
-    , mipFlag       ( false )
-    , ispMode       ( NOT_INTRA_SUBPARTITIONS )
-    , ispLfnstIdx   ( 0 )
-    , stopNonDCT2Transforms
-                    ( false )
+  void init( const CodingStructure& cs, const uint32_t _minDepth, const uint32_t _maxDepth )
   {
+    minDepth                  = _minDepth;
+    maxDepth                  = _maxDepth;
+    testModes.clear();
+    lastTestMode              = EncTestMode();
+    earlySkip                 = false;
+    isHashPerfectMatch        = false;
+    bestCS                    = nullptr;
+    bestCU                    = nullptr;
+    bestTU                    = nullptr;
+    features                  = ComprCUFeatures();
+#if FEATURE_TEST
+    dtShadow.reset();
+    dtSchedule.reset();
+#endif
+    bestInterCost             = MAX_DOUBLE;
+    bestMtsSize2Nx2N1stPass   = MAX_DOUBLE;
+    skipSecondMTSPass         = false;
+    interHad                  = std::numeric_limits<Distortion>::max();
+#if ENABLE_SPLIT_PARALLELISM
+    isLevelSplitParallel      = false;
+#endif
+    bestCostWithoutSplitFlags = MAX_DOUBLE;
+    bestCostMtsFirstPassNoIsp = MAX_DOUBLE;
+    bestCostIsp               = MAX_DOUBLE;
+    ispWasTested              = false;
+    bestPredModeDCT2          = UINT8_MAX;
+    relatedCuIsValid          = false;
+    ispPredModeVal            = 0;
+    bestDCT2NonISPCost        = MAX_DOUBLE;
+    bestNonDCT2Cost           = MAX_DOUBLE;
+    bestISPIntraMode          = UINT8_MAX;
+    mipFlag                   = false;
+    ispMode                   = NOT_INTRA_SUBPARTITIONS;
+    ispLfnstIdx               = 0;
+    stopNonDCT2Transforms     = false;
+
     getAreaIdx( cs.area.Y(), *cs.pcv, cuX, cuY, cuW, cuH );
     partIdx = ( ( cuX << 8 ) | cuY );
-
-    extraFeatures.reserve( numExtraFeatures );
-    extraFeatures.resize ( numExtraFeatures, 0 );
-
-    extraFeaturesd.reserve( numExtraFeatures );
-    extraFeaturesd.resize ( numExtraFeatures, 0.0 );
   }
 
   unsigned                          minDepth;
@@ -251,8 +297,11 @@ struct ComprCUCtx
   CodingStructure                  *bestCS;
   CodingUnit                       *bestCU;
   TransformUnit                    *bestTU;
-  static_vector<int64_t,  30>         extraFeatures;
-  static_vector<double, 30>         extraFeaturesd;
+  ComprCUFeatures                   features;
+#if FEATURE_TEST
+  DTShadowCU                        dtShadow;
+  DTSplitSchedule                   dtSchedule;
+#endif
   double                            bestInterCost;
   double                            bestMtsSize2Nx2N1stPass;
   bool                              skipSecondMTSPass;
@@ -274,10 +323,6 @@ struct ComprCUCtx
   uint8_t                           ispMode;
   uint8_t                           ispLfnstIdx;
   bool                              stopNonDCT2Transforms;
-
-  template<typename T> T    get( int ft )       const { return typeid(T) == typeid(double) ? (T&)extraFeaturesd[ft] : T(extraFeatures[ft]); }
-  template<typename T> void set( int ft, T val )      { extraFeatures [ft] = int64_t( val ); }
-  void                      set( int ft, double val ) { extraFeaturesd[ft] = val; }
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -304,6 +349,9 @@ protected:
   InterSearch*          m_pcInterSearch;
 
   bool                  m_doPlt;
+#if FEATURE_TEST
+  float                 m_dtThresholdOffset;   ///< added to the DT thresholds, set per CTU by the time budget
+#endif
 
 public:
 
@@ -311,7 +359,7 @@ public:
 
   virtual void create               ( const EncCfg& cfg )                                                                   = 0;
   virtual void destroy              ()                                                                                      = 0;
-  virtual void initCTUEncoding      ( const Slice &slice )                                                                  = 0;
+  virtual void initCTUEncoding      ( const Slice &slice, const unsigned ctuRsAddr )                                        = 0;
   virtual void initCULevel          ( Partitioner &partitioner, const CodingStructure& cs )                                 = 0;
   virtual void finishCULevel        ( Partitioner &partitioner )                                                            = 0;
 
@@ -323,6 +371,10 @@ public:
 
   virtual bool useModeResult        ( const EncTestMode& encTestmode, CodingStructure*& tempCS,  Partitioner& partitioner ) = 0;
   virtual bool checkSkipOtherLfnst  ( const EncTestMode& encTestmode, CodingStructure*& tempCS,  Partitioner& partitioner ) = 0;
+#if FEATURE_TEST
+  virtual bool skipDTInterTool      ( const DTDecision decision )                                                           const { return false; }
+  virtual DTTelemetry* getDTTelemetry()                                                                                           { return nullptr; }
+#endif
 #if ENABLE_SPLIT_PARALLELISM
   virtual void copyState            ( const EncModeCtrl& other, const UnitArea& area );
   virtual int  getNumParallelJobs   ( const CodingStructure &cs, Partitioner& partitioner )                                 const { return 1;     }
@@ -385,6 +437,9 @@ public:
   void setInterSearch                 (InterSearch* pcInterSearch)   { m_pcInterSearch = pcInterSearch; }
   void   setPltEnc                    ( bool b )                { m_doPlt = b; }
   bool   getPltEnc()                                      const { return m_doPlt; }
+#if FEATURE_TEST
+  void   setDTThresholdOffset         ( float offset )          { m_dtThresholdOffset = offset; }
+#endif
 
 protected:
   void xExtractFeatures ( const EncTestMode encTestmode, CodingStructure& cs );
@@ -506,6 +561,38 @@ public:
   char  getSelectColorSpaceOption(const UnitArea& area);
 };
 
+#if FEATURE_TEST
+// features of the inter DT decisions that only depend on the CU area: pixel and motion statistics, QP and temporal layer
+struct DTCachedFeatures
+{
+  uint64_t ctuStamp;    // the entry belongs to the CTU of this stamp
+  int      qp;
+  bool     noZeroDenom;
+  bool     horVerValid;
+  float    qTMTT [34];
+  float    horVer[45];
+};
+
+// per-CTU cache of the inter DT features keyed by the CU area (x, y, width, height), so that a CU reached through
+// several split series (e.g. BT_H and BT_V of its parent, or QT and BT paths) computes its statistics only once
+class DTFeatureCache
+{
+  static const int NUM_POS   = MAX_CU_SIZE >> MIN_CU_LOG2;
+  static const int NUM_SIZES = MAX_CU_DEPTH - 2;   // 8 to 128
+
+  std::vector<DTCachedFeatures> m_entries;
+  uint64_t                      m_ctuStamp;
+
+public:
+
+  void create ();
+  void init   ()  { m_ctuStamp++; }   // invalidates all entries, called per CTU
+
+  // entry of an area of at least 8x8, cached is false if it has to be (re)computed
+  DTCachedFeatures& get( const CompArea& area, const int qp, bool& cached );
+};
+
+#endif
 #if REUSE_CU_RESULTS
 struct BestEncodingInfo
 {
@@ -578,53 +665,46 @@ class EncModeCtrlMTnoRQT : public EncModeCtrl, public CacheBlkInfoCtrl
 #endif
   , public SaveLoadEncInfoSbt
 {
-  enum ExtraFeatures
-  {
-    DID_HORZ_SPLIT = 0,
-    DID_VERT_SPLIT,
-    DID_QUAD_SPLIT,
-    BEST_HORZ_SPLIT_COST,
-    BEST_VERT_SPLIT_COST,
-    BEST_TRIH_SPLIT_COST,
-    BEST_TRIV_SPLIT_COST,
-    DO_TRIH_SPLIT,
-    DO_TRIV_SPLIT,
-    BEST_NON_SPLIT_COST,
-    BEST_NO_IMV_COST,
-    BEST_IMV_COST,
-    QT_BEFORE_BT,
-    IS_BEST_NOSPLIT_SKIP,
-    MAX_QT_SUB_DEPTH,
-#if REUSE_CU_RESULTS
-    IS_REUSING_CU,
-#endif
-
-#if  FEATURE_TEST
-	BEST_QT_COST,
-	NO_SPLIT_FLAG,
-	QT_FLAG,
-	HOR_FLAG,
-#endif
-#if DISABLE_RF_IF_EMPTY_CU_WHEN_FULL
-	EMPTY_CU_WHEN_FULL,
-#endif
+  unsigned m_skipThreshold;
 #if FEATURE_TEST
-	IS_NON_SPLIT_INTER,
-	IS_NON_SPLIT_MERGE,
-	IS_NON_SPLIT_INTRA,
-	IS_NON_SPLIT_GEO,
+  bool                            m_dtInfer;           ///< splits are pruned by the decision trees
+  DTThresholds                    m_dtThresholds;
+  DTThresholdController           m_dtControl;
+  std::shared_ptr<const DTForest> m_dtForest;
+  RandomForestClassfier           m_rf;
+  int                             m_dtBenchmarkReps;   ///< repetitions of each timed prediction, 0 if the benchmark is off
+  DTForestBenchmark               m_dtBenchmark;
+  DTFeatureCache                  m_dtFeatureCache;
+  std::unique_ptr<DTTelemetry>    m_dtTelemetry;       ///< only allocated when the telemetry is on
+  bool                            m_dtShadow;          ///< the decisions are predicted and evaluated, but nothing is pruned
+  DTShadowStats                   m_dtShadowStats;
+  DTSplitOrder                    m_dtSplitOrder;
+  double                          m_dtSplitOrderMargin;
+
+  void xBenchmarkDTForest         ( const DTDecision decision, const int width, const int height, float* features );
+  void xAuditDTDecisions          ( const Partitioner& partitioner );
+  void xShadowDTDecisions         ( const Partitioner& partitioner );
+  DTSplitCosts xGetDTSplitCosts   ( const ComprCUCtx& cuECtx ) const;
+  void xComputeInterFeatures      ( const CodingStructure& cs, const Partitioner& partitioner, DTCachedFeatures& features ) const;
+  bool xGetInterFeatures          ( const CodingStructure& cs, const Partitioner& partitioner, ComprCUCtx& cuECtx, float* qTMTTFeatures, float* horVerFeatures, bool& horVerValid );
+  void xGetBTTTFeatures           ( const CodingStructure& cs, const ComprCUCtx& cuECtx, const CompArea& area, const bool horSplit, float* features ) const;
+  void xDecideBTTT                ( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx );
+  void xGetIntraFeatures          ( const CodingStructure& cs, const Partitioner& partitioner, const ComprCUCtx& cuECtx, float* features ) const;
+  void xDecideIntraDT             ( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx );
+  void xDecideInterTools          ( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx );
+  void xOrderDTSplits             ( const CodingStructure& cs, Partitioner& partitioner, ComprCUCtx& cuECtx ) const;
+  bool xTerminateDTSplits         ( ComprCUCtx& cuECtx ) const;
+
+  std::shared_ptr<DTDatasetWriter> m_dtDataset;         ///< only open when the dataset is collected
+  DTSamplingPolicy                 m_dtSampling;
+  bool                             m_dtCollectCtu;      ///< the current CTU contributes to the dataset
 #endif
 
-    NUM_EXTRA_FEATURES
-  };
-
-  unsigned m_skipThreshold;
-
 public:
 
   virtual void create             ( const EncCfg& cfg );
   virtual void destroy            ();
-  virtual void initCTUEncoding    ( const Slice &slice );
+  virtual void initCTUEncoding    ( const Slice &slice, const unsigned ctuRsAddr );
   virtual void initCULevel        ( Partitioner &partitioner, const CodingStructure& cs );
   virtual void finishCULevel      ( Partitioner &partitioner );
 
@@ -639,6 +719,10 @@ public:
   virtual bool parallelJobSelector( const EncTestMode& encTestmode, const CodingStructure &cs, Partitioner& partitioner ) const;
 #endif
   virtual bool checkSkipOtherLfnst( const EncTestMode& encTestmode, CodingStructure*& tempCS, Partitioner& partitioner );
+#if FEATURE_TEST
+  virtual bool skipDTInterTool    ( const DTDecision decision ) const;
+  virtual DTTelemetry* getDTTelemetry()                         { return m_dtTelemetry.get(); }
+#endif
 };
 
 
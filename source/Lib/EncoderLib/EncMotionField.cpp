@@ -0,0 +1,632 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     EncMotionField.cpp
+    \brief    picture-level block motion field for the DT partitioning features
+*/
+
+#include "EncMotionField.h"
+#include "EncTemporalFilter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+//! \ingroup EncoderLib
+//! \{
+
+static const int s_diamondLocations     [9][2] = { {0,0}, {0,2}, {1,1} , {2,0}, {1,-1}, {0,-2}, {-1,-1}, {-2,0}, {-1,1} };
+static const int s_diamondLocationsSmall[4][2] = { {0,1}, {1,0}, {-1,0}, {0,-1} };
+
+void MotionAnalysisCache::store( const int poc, const int refPoc, MotionAnalysis&& analysis )
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_entries[std::make_pair( poc, refPoc )] = std::move( analysis );
+}
+
+const MotionAnalysis* MotionAnalysisCache::find( const int poc, const int refPoc ) const
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  auto entry = m_entries.find( std::make_pair( poc, refPoc ) );
+  return entry == m_entries.end() ? nullptr : &entry->second;
+}
+
+void MotionAnalysisCache::release( const int poc )
+{
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_entries.erase( m_entries.lower_bound( std::make_pair( poc, std::numeric_limits<int>::min() ) ), m_entries.upper_bound( std::make_pair( poc, std::numeric_limits<int>::max() ) ) );
+}
+
+EncMotionField::EncMotionField()
+  : m_numThreads ( 1 )
+  , m_maxCUWidth ( 0 )
+  , m_maxCUHeight( 0 )
+  , m_hierarchical( false )
+  , m_cache( nullptr )
+  , m_rowBatch( nullptr )
+  , m_rowBatchId( 0 )
+  , m_rowPending( 0 )
+  , m_rowStop( false )
+  , m_lookAheadStop( false )
+{
+}
+
+void EncMotionField::init( const int numThreads, const int maxCUWidth, const int maxCUHeight, const bool hierarchical, const MotionAnalysisCache* cache )
+{
+  m_numThreads   = std::max( numThreads, 1 );
+  m_maxCUWidth   = maxCUWidth;
+  m_maxCUHeight  = maxCUHeight;
+  m_hierarchical = hierarchical;
+  m_cache        = cache;
+
+  CHECK( !m_rowWorkers.empty(), "Motion field workers are already running" );
+
+  for( int i = 1; i < m_numThreads; i++ )
+  {
+    m_rowWorkers.emplace_back( &EncMotionField::xRowWorker, this, m_rowBatchId );
+  }
+}
+
+void EncMotionField::destroy()
+{
+  if( m_lookAheadThread.joinable() )
+  {
+    {
+      std::unique_lock<std::mutex> lock( m_lookAheadMutex );
+      m_lookAheadStop = true;
+    }
+    m_lookAheadStart.notify_all();
+    m_lookAheadThread.join();
+
+    m_lookAheadJobs.clear();
+    m_lookAheadStop = false;
+  }
+
+  if( !m_rowWorkers.empty() )
+  {
+    {
+      std::unique_lock<std::mutex> lock( m_rowMutex );
+      m_rowStop = true;
+    }
+    m_rowStart.notify_all();
+
+    for( auto& worker : m_rowWorkers )
+    {
+      worker.join();
+    }
+
+    m_rowWorkers.clear();
+    m_rowStop = false;
+  }
+}
+
+void EncMotionField::estimate( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int distScale, const int bitDepth, MotionField& field )
+{
+  if( m_hierarchical )
+  {
+    xEstimateHierarchical( org, ref, refPadded, distScale, bitDepth, field );
+    return;
+  }
+
+  const int numBlkRows = field.getNumBlkRows();
+  const int blkStride  = field.getNumBlkCols();
+  const int marginX    = refPadded ? m_maxCUWidth  + 16 : 0;
+  const int marginY    = refPadded ? m_maxCUHeight + 16 : 0;
+  const Mv  zeroMv;
+
+  xRunRows( numBlkRows, org, ref, bitDepth, [&]( DistParam& distParam, const int blkRow )
+  {
+    const int yOrg = blkRow * BLOCK_SIZE;
+
+    for( int xOrg = 0; xOrg < org.width; xOrg += BLOCK_SIZE )
+    {
+      const int blkIdx = blkRow * blkStride + xOrg / BLOCK_SIZE;
+
+      Mv  mv;
+      int sad;
+      xEstimateBlock( distParam, org, ref, marginX, marginY, xOrg, yOrg, distScale, SEARCH_RANGE, &zeroMv, 1, MAX_INT, mv, sad );
+      field.setMv ( blkIdx, mv );
+      field.setSAD( blkIdx, sad );
+    }
+  } );
+}
+
+void EncMotionField::estimate( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int poc, const int refPoc, const int bitDepth, MotionField& field )
+{
+  const MotionAnalysis* seed = m_cache ? m_cache->find( poc, refPoc ) : nullptr;
+
+  if( seed )
+  {
+    xEstimateSeeded( org, ref, refPadded, poc - refPoc, bitDepth, *seed, field );
+  }
+  else
+  {
+    estimate( org, ref, refPadded, poc - refPoc, bitDepth, field );
+  }
+}
+
+void EncMotionField::xRunRows( const int numBlkRows, const CPelBuf& org, const CPelBuf& ref, const int bitDepth, const std::function<void( DistParam&, int )>& estimateRow )
+{
+  RowBatch batch;
+  batch.numBlkRows  = numBlkRows;
+  batch.org         = org;
+  batch.ref         = ref;
+  batch.bitDepth    = bitDepth;
+  batch.estimateRow = &estimateRow;
+  batch.nextRow     = 0;
+
+  if( m_rowWorkers.empty() || numBlkRows < 2 )
+  {
+    xEstimateRows( batch );
+    return;
+  }
+
+  std::unique_lock<std::mutex> batchLock( m_rowBatchMutex );
+
+  {
+    std::unique_lock<std::mutex> lock( m_rowMutex );
+    m_rowBatch   = &batch;
+    m_rowPending = int( m_rowWorkers.size() );
+    m_rowBatchId++;
+  }
+  m_rowStart.notify_all();
+
+  xEstimateRows( batch );
+
+  // the batch lives on this stack, every worker has to be done with it before returning
+  std::unique_lock<std::mutex> lock( m_rowMutex );
+  m_rowDone.wait( lock, [this]() { return m_rowPending == 0; } );
+  m_rowBatch = nullptr;
+}
+
+void EncMotionField::xEstimateRows( RowBatch& batch )
+{
+  // blocks of a row only depend on blocks to their left, the result does not depend on the number of threads
+  DistParam distParam;
+  m_rdCost.setDistParam( distParam, CPelBuf( batch.org.buf, batch.org.stride, BLOCK_SIZE, BLOCK_SIZE ), batch.ref.buf, batch.ref.stride, batch.bitDepth, COMPONENT_Y, 0, 1, false );
+
+  for( int blkRow = batch.nextRow++; blkRow < batch.numBlkRows; blkRow = batch.nextRow++ )
+  {
+    ( *batch.estimateRow )( distParam, blkRow );
+  }
+}
+
+void EncMotionField::xRowWorker( uint64_t batchId )
+{
+  std::unique_lock<std::mutex> lock( m_rowMutex );
+
+  while( true )
+  {
+    m_rowStart.wait( lock, [&]() { return m_rowStop || m_rowBatchId != batchId; } );
+
+    if( m_rowStop )
+    {
+      return;
+    }
+
+    batchId          = m_rowBatchId;
+    RowBatch* batch  = m_rowBatch;
+    lock.unlock();
+
+    xEstimateRows( *batch );
+
+    lock.lock();
+    if( --m_rowPending == 0 )
+    {
+      m_rowDone.notify_one();
+    }
+  }
+}
+
+/** Coarse-to-fine search on the original resolution and on two 2:1 subsampled levels.
+ *  The quarter resolution level gets the full diamond search from zero and from the left neighbour. Every finer
+ *  block starts at the best of zero, its left neighbour, its parent block and the two parent neighbours next to it
+ *  and is only refined by the small diamond. The finest level is searched on the distScale grid, MVs and SADs have
+ *  the same units as those of the plain diamond search.
+ */
+void EncMotionField::xEstimateHierarchical( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int distScale, const int bitDepth, MotionField& field )
+{
+  PelStorage orgSub[COARSE_LEVELS];
+  PelStorage refSub[COARSE_LEVELS];
+  std::vector<Mv>  mvSub [COARSE_LEVELS + 1];
+  std::vector<int> sadSub[COARSE_LEVELS + 1];
+
+  MotionLevel levels[COARSE_LEVELS + 1];
+
+  levels[0].org        = org;
+  levels[0].ref        = ref;
+  levels[0].marginX    = refPadded ? m_maxCUWidth  + 16 : 0;
+  levels[0].marginY    = refPadded ? m_maxCUHeight + 16 : 0;
+  levels[0].step       = distScale;
+  levels[0].range      = std::max( SEARCH_RANGE, ( SEARCH_RANGE << COARSE_LEVELS ) / std::abs( distScale ) );
+  levels[0].maxIter    = std::abs( distScale ) > 1 ? 1 : 0;   // parent MVs are rounded to the coarser distScale grid
+  levels[0].numBlkCols = field.getNumBlkCols();
+  levels[0].numBlkRows = field.getNumBlkRows();
+
+  for( int i = 1; i <= COARSE_LEVELS; i++ )
+  {
+    // the subsampled pictures are border-extended by the scaled picture margin
+    const int padding = ( std::max( m_maxCUWidth, m_maxCUHeight ) + 16 ) >> i;
+
+    EncTemporalFilter::subsampleLuma( levels[i - 1].org, orgSub[i - 1], CHROMA_400, padding );
+    EncTemporalFilter::subsampleLuma( levels[i - 1].ref, refSub[i - 1], CHROMA_400, padding );
+
+    MotionLevel& level = levels[i];
+    level.org        = orgSub[i - 1].Y();
+    level.ref        = refSub[i - 1].Y();
+    level.marginX    = padding;
+    level.marginY    = padding;
+    level.step       = 1;
+    level.range      = SEARCH_RANGE << ( COARSE_LEVELS - i );
+    level.maxIter    = i == COARSE_LEVELS ? MAX_INT : 0;
+    level.numBlkCols = ( level.org.width  + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+    level.numBlkRows = ( level.org.height + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+
+  }
+
+  // every level is searched at full precision, the finest one is packed into the motion field afterwards
+  for( int i = 0; i <= COARSE_LEVELS; i++ )
+  {
+    mvSub [i].resize( levels[i].numBlkCols * levels[i].numBlkRows );
+    sadSub[i].resize( levels[i].numBlkCols * levels[i].numBlkRows );
+    levels[i].mv  = mvSub [i].data();
+    levels[i].sad = sadSub[i].data();
+  }
+
+  for( int i = COARSE_LEVELS; i >= 0; i-- )
+  {
+    xEstimateLevel( levels[i], i < COARSE_LEVELS ? &levels[i + 1] : nullptr, bitDepth );
+  }
+
+  for( int blkIdx = 0; blkIdx < levels[0].numBlkCols * levels[0].numBlkRows; blkIdx++ )
+  {
+    field.setMv ( blkIdx, levels[0].mv [blkIdx] );
+    field.setSAD( blkIdx, levels[0].sad[blkIdx] );
+  }
+}
+
+void EncMotionField::xEstimateLevel( const MotionLevel& level, const MotionLevel* parent, const int bitDepth )
+{
+  // a parent MV unit covers 2 * parent->step samples of this level
+  auto scaleParentMv = [&]( const Mv& mv )
+  {
+    const int scale = 2 * parent->step;
+    return Mv( ( int ) std::lround( ( double ) ( mv.getHor() * scale ) / level.step ), ( int ) std::lround( ( double ) ( mv.getVer() * scale ) / level.step ) );
+  };
+
+  xRunRows( level.numBlkRows, level.org, level.ref, bitDepth, [&]( DistParam& distParam, const int blkRow )
+  {
+    for( int blkCol = 0; blkCol < level.numBlkCols; blkCol++ )
+    {
+      const int blkIdx = blkRow * level.numBlkCols + blkCol;
+
+      Mv  cands[5];
+      int numCands = 0;
+
+      cands[numCands++] = Mv( 0, 0 );
+
+      if( blkCol > 0 )
+      {
+        cands[numCands++] = level.mv[blkIdx - 1];
+      }
+
+      if( parent )
+      {
+        const int px = std::min( blkCol >> 1, parent->numBlkCols - 1 );
+        const int py = std::min( blkRow >> 1, parent->numBlkRows - 1 );
+        const int nx = px + ( ( blkCol & 1 ) ? 1 : -1 );
+        const int ny = py + ( ( blkRow & 1 ) ? 1 : -1 );
+
+        cands[numCands++] = scaleParentMv( parent->mv[py * parent->numBlkCols + px] );
+
+        if( nx >= 0 && nx < parent->numBlkCols )
+        {
+          cands[numCands++] = scaleParentMv( parent->mv[py * parent->numBlkCols + nx] );
+        }
+        if( ny >= 0 && ny < parent->numBlkRows )
+        {
+          cands[numCands++] = scaleParentMv( parent->mv[ny * parent->numBlkCols + px] );
+        }
+      }
+
+      xEstimateBlock( distParam, level.org, level.ref, level.marginX, level.marginY, blkCol * BLOCK_SIZE, blkRow * BLOCK_SIZE, level.step, level.range,
+                      cands, numCands, level.maxIter, level.mv[blkIdx], level.sad[blkIdx] );
+    }
+  } );
+}
+
+/** Refinement of a motion field found by an earlier search, usually the temporal filter.
+ *  Every block starts at the best of zero, its left neighbour and the cached MV of the block covering it, and is
+ *  refined like the finest level of the hierarchical search.
+ */
+void EncMotionField::xEstimateSeeded( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int distScale, const int bitDepth, const MotionAnalysis& seed, MotionField& field )
+{
+  const int numBlkRows = field.getNumBlkRows();
+  const int blkStride  = field.getNumBlkCols();
+  const int marginX    = refPadded ? m_maxCUWidth  + 16 : 0;
+  const int marginY    = refPadded ? m_maxCUHeight + 16 : 0;
+  const int range      = std::max( SEARCH_RANGE, ( SEARCH_RANGE << COARSE_LEVELS ) / std::abs( distScale ) );
+  const int maxIter    = std::abs( distScale ) > 1 ? 1 : 0;
+  const double scale   = 1.0 / ( seed.mvPrecision * distScale );
+
+  xRunRows( numBlkRows, org, ref, bitDepth, [&]( DistParam& distParam, const int blkRow )
+  {
+    const int yOrg   = blkRow * BLOCK_SIZE;
+    const int seedY  = std::min( yOrg / seed.blockSize, seed.numBlkRows - 1 );
+
+    for( int xOrg = 0; xOrg < org.width; xOrg += BLOCK_SIZE )
+    {
+      const int blkIdx = blkRow * blkStride + xOrg / BLOCK_SIZE;
+      const int seedX  = std::min( xOrg / seed.blockSize, seed.numBlkCols - 1 );
+      const Mv& seedMv = seed.mvs[seedY * seed.numBlkCols + seedX];
+
+      Mv  cands[3];
+      int numCands = 0;
+
+      cands[numCands++] = Mv( 0, 0 );
+      cands[numCands++] = Mv( ( int ) std::lround( seedMv.getHor() * scale ), ( int ) std::lround( seedMv.getVer() * scale ) );
+
+      if( xOrg > 0 )
+      {
+        cands[numCands++] = field.getMv( blkIdx - 1 );
+      }
+
+      Mv  mv;
+      int sad;
+      xEstimateBlock( distParam, org, ref, marginX, marginY, xOrg, yOrg, distScale, range, cands, numCands, maxIter, mv, sad );
+      field.setMv ( blkIdx, mv );
+      field.setSAD( blkIdx, sad );
+    }
+  } );
+}
+
+void EncMotionField::scheduleLookAhead( Picture* pic, const Picture* refPic, const int bitDepth )
+{
+  {
+    std::unique_lock<std::mutex> lock( m_lookAheadMutex );
+    m_lookAheadJobs.push_back( LookAheadJob{ pic, refPic, bitDepth, LOOKAHEAD_PENDING } );
+  }
+
+  if( !m_lookAheadThread.joinable() )
+  {
+    m_lookAheadThread = std::thread( &EncMotionField::xLookAheadWorker, this );
+  }
+  m_lookAheadStart.notify_one();
+}
+
+int EncMotionField::waitLookAhead( const Picture* pic )
+{
+  std::unique_lock<std::mutex> lock( m_lookAheadMutex );
+
+  auto job = std::find_if( m_lookAheadJobs.begin(), m_lookAheadJobs.end(), [pic]( const LookAheadJob& j ) { return j.pic == pic; } );
+  if( job == m_lookAheadJobs.end() )
+  {
+    return -1;
+  }
+
+  m_lookAheadDone.wait( lock, [&job]() { return job->state == LOOKAHEAD_DONE; } );
+
+  const int refPoc = job->refPic->getPOC();
+  m_lookAheadJobs.erase( job );
+  return refPoc;
+}
+
+void EncMotionField::flushLookAhead()
+{
+  std::unique_lock<std::mutex> lock( m_lookAheadMutex );
+
+  m_lookAheadJobs.remove_if( []( const LookAheadJob& j ) { return j.state == LOOKAHEAD_PENDING; } );
+  m_lookAheadDone.wait( lock, [this]() { return std::none_of( m_lookAheadJobs.begin(), m_lookAheadJobs.end(), []( const LookAheadJob& j ) { return j.state == LOOKAHEAD_RUNNING; } ); } );
+  m_lookAheadJobs.clear();
+}
+
+void EncMotionField::xLookAheadWorker()
+{
+  std::unique_lock<std::mutex> lock( m_lookAheadMutex );
+
+  while( true )
+  {
+    auto job = m_lookAheadJobs.end();
+    m_lookAheadStart.wait( lock, [&]()
+    {
+      job = std::find_if( m_lookAheadJobs.begin(), m_lookAheadJobs.end(), []( const LookAheadJob& j ) { return j.state == LOOKAHEAD_PENDING; } );
+      return m_lookAheadStop || job != m_lookAheadJobs.end();
+    } );
+
+    if( m_lookAheadStop )
+    {
+      return;
+    }
+
+    // list iterators stay valid while other jobs are added or removed, the running job is only erased once it is done
+    job->state = LOOKAHEAD_RUNNING;
+    Picture*       pic    = job->pic;
+    const Picture* refPic = job->refPic;
+    const int      bitDepth = job->bitDepth;
+    lock.unlock();
+
+    // the true originals are never written while the GOP is coded, unlike the originals of intra pictures, which are
+    // reshaped in place under LMCS; they have no margin
+    estimate( pic->getTrueOrigBuf().get( COMPONENT_Y ), refPic->getTrueOrigBuf().get( COMPONENT_Y ), false, pic->getPOC(), refPic->getPOC(), bitDepth, *pic->getMotionField() );
+
+    lock.lock();
+    job->state = LOOKAHEAD_DONE;
+    m_lookAheadDone.notify_all();
+  }
+}
+
+void EncMotionField::xEstimateBlock( DistParam& distParam, const CPelBuf& org, const CPelBuf& ref, const int marginX, const int marginY, const int xOrg, const int yOrg, const int distScale, const int range,
+                                     const Mv* cands, const int numCands, const int maxIter, Mv& mv, int& sad ) const
+{
+  const int p  = range;
+  const int wd = org.width;
+  const int ht = org.height;
+
+  distParam.org.buf = org.bufAt( xOrg, yOrg );
+
+  auto meError = [&]( const int xRef, const int yRef )
+  {
+    distParam.cur.buf = ref.bufAt( xRef, yRef );
+    return distParam.distFunc( distParam );
+  };
+
+  // the reference is read up to the end of the picture margin
+  auto outside = [&]( const int xRef, const int yRef )
+  {
+    return xRef < -marginX || xRef > wd + marginX - BLOCK_SIZE || yRef < -marginY || yRef > ht + marginY - BLOCK_SIZE;
+  };
+
+  int bestX = cands[0].getHor(), bestY = cands[0].getVer(), prevBestX = 0, prevBestY = 0;
+  Distortion minSum = std::numeric_limits<Distortion>::max();
+
+  if( numCands > 1 )
+  {
+    for( int i = 0; i < numCands; i++ )
+    {
+      const int mvX = cands[i].getHor();
+      const int mvY = cands[i].getVer();
+
+      if( std::find( cands, cands + i, cands[i] ) != cands + i )
+      {
+        continue;
+      }
+
+      if( outside( xOrg + mvX * distScale, yOrg + mvY * distScale ) || mvX < -p || mvX > p || mvY < -p || mvY > p )
+      {
+        continue;
+      }
+
+      const Distortion cost = meError( xOrg + mvX * distScale, yOrg + mvY * distScale );
+      if( minSum > cost )
+      {
+        minSum = cost;
+        bestX  = mvX;
+        bestY  = mvY;
+      }
+    }
+  }
+  bool testNext = true;
+  int iter = 0;
+  int prevDiamondLoc[9][2] = { {p,p}, {p,p}, {p,p} , {p,p}, {p,p}, {p,p}, {p,p}, {p,p}, {p,p} };
+
+  while( testNext && iter < maxIter )
+  {
+    prevBestX = bestX;  prevBestY = bestY;
+    const int x = bestX, y = bestY;
+    int currDiamondLoc[9][2] = { {0,0}, {0,0}, {0,0} , {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0} };
+
+    for( int i = 0; i < 9; i++ )
+    {
+      const int mvX  = x + s_diamondLocations[i][0];
+      const int mvY  = y + s_diamondLocations[i][1];
+      const int xRef = xOrg + mvX * distScale;
+      const int yRef = yOrg + mvY * distScale;
+
+      currDiamondLoc[i][0] = mvX;
+      currDiamondLoc[i][1] = mvY;
+
+      const bool boundary = outside( xRef, yRef );
+
+      bool limit = mvX < -p || mvX > p;
+      limit = limit || mvY < -p || mvY > p;
+
+      if( boundary || limit )
+      {
+        continue;
+      }
+
+      bool foundMatch = false;
+      if( iter )
+      {
+        for( int ii = 0; ii < 9; ii++ )
+        {
+          if( mvX == prevDiamondLoc[ii][0] && mvY == prevDiamondLoc[ii][1] )
+          {
+            foundMatch = true;
+            break;
+          }
+        }
+      }
+
+      if( foundMatch )
+      {
+        continue;
+      }
+
+      const Distortion cost = meError( xRef, yRef );
+      if( minSum > cost )
+      {
+        minSum = cost;
+        bestX  = mvX;
+        bestY  = mvY;
+      }
+    }
+
+    if( prevBestX == bestX && prevBestY == bestY )
+    {
+      testNext = false;
+    }
+
+    if( testNext )
+    {
+      memcpy( prevDiamondLoc, currDiamondLoc, sizeof( prevDiamondLoc ) );
+    }
+    iter++;
+  }
+
+  const int x = bestX, y = bestY;
+  for( int i = 0; i < 4; i++ )
+  {
+    const int xRef = xOrg + ( x + s_diamondLocationsSmall[i][0] ) * distScale;
+    const int yRef = yOrg + ( y + s_diamondLocationsSmall[i][1] ) * distScale;
+
+    if( outside( xRef, yRef ) )
+    {
+      continue;
+    }
+
+    const Distortion cost = meError( xRef, yRef );
+    if( minSum > cost )
+    {
+      minSum = cost;
+      bestX  = x + s_diamondLocationsSmall[i][0];
+      bestY  = y + s_diamondLocationsSmall[i][1];
+    }
+  }
+
+  mv.set( bestX, bestY );
+  sad = ( int ) minSum;
+}
+
+//! \}
@@ -0,0 +1,196 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2020, ITU/ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ITU/ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \file     EncMotionField.h
+    \brief    picture-level block motion field for the DT partitioning features (header)
+*/
+
+#ifndef __ENCMOTIONFIELD__
+#define __ENCMOTIONFIELD__
+
+#include "CommonLib/CommonDef.h"
+#include "CommonLib/Unit.h"
+#include "CommonLib/Mv.h"
+#include "CommonLib/RdCost.h"
+#include "CommonLib/Picture.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \ingroup EncoderLib
+//! \{
+
+// ====================================================================================================================
+// Class definition
+// ====================================================================================================================
+
+/// block motion field of a picture against one reference, as found by an earlier motion search
+struct MotionAnalysis
+{
+  int             blockSize;     ///< luma samples per block side
+  int             mvPrecision;   ///< MV units per luma sample
+  int             numBlkCols;
+  int             numBlkRows;
+  std::vector<Mv> mvs;
+};
+
+/// motion fields keyed by (POC, reference POC), written by the temporal filter and read by the DT motion field
+class MotionAnalysisCache
+{
+public:
+  void store  ( const int poc, const int refPoc, MotionAnalysis&& analysis );
+  /// the entry stays valid until the POC is released
+  const MotionAnalysis* find( const int poc, const int refPoc ) const;
+  void release( const int poc );
+
+private:
+  mutable std::mutex                               m_mutex;
+  std::map<std::pair<int, int>, MotionAnalysis>    m_entries;
+};
+
+/// diamond search of every 4x4 luma block, rows of blocks are distributed over a pool of worker threads
+class EncMotionField
+{
+public:
+  static const int BLOCK_SIZE    = MotionField::BLOCK_SIZE;
+  static const int SEARCH_RANGE  = 64;
+  static const int COARSE_LEVELS = 2;   ///< half and quarter resolution levels of the hierarchical search
+
+  EncMotionField();
+  ~EncMotionField() { destroy(); }
+
+  void init    ( const int numThreads, const int maxCUWidth, const int maxCUHeight, const bool hierarchical, const MotionAnalysisCache* cache );
+  void destroy ();
+
+  /// MVs are in units of distScale luma samples, the SAD of the best position is stored per block.
+  /// The search reads up to the picture margin of the reference only if it is border-extended (refPadded).
+  void estimate( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int distScale, const int bitDepth, MotionField& field );
+  /// as estimate(), refines the cached motion field of (poc, refPoc) instead of searching if there is one
+  void estimate( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int poc, const int refPoc, const int bitDepth, MotionField& field );
+
+  // look-ahead: the motion fields of later pictures are estimated between original pictures by a background thread
+  void scheduleLookAhead( Picture* pic, const Picture* refPic, const int bitDepth );
+  /// waits for the look-ahead job of the picture, returns the POC of its reference or -1 if no job was scheduled
+  int  waitLookAhead    ( const Picture* pic );
+  /// drops the jobs that have not been started and waits for the running one
+  void flushLookAhead   ();
+
+private:
+  enum LookAheadState
+  {
+    LOOKAHEAD_PENDING = 0,
+    LOOKAHEAD_RUNNING,
+    LOOKAHEAD_DONE
+  };
+
+  struct LookAheadJob
+  {
+    Picture*       pic;
+    const Picture* refPic;
+    int            bitDepth;
+    LookAheadState state;
+  };
+
+  /// one resolution of the hierarchical search, MVs are in units of step samples of the level
+  struct MotionLevel
+  {
+    CPelBuf org;
+    CPelBuf ref;
+    int     marginX;
+    int     marginY;
+    int     step;
+    int     range;
+    int     maxIter;
+    int     numBlkCols;
+    int     numBlkRows;
+    Mv*     mv;
+    int*    sad;
+  };
+
+  /// rows of one picture or level, shared by the calling thread and the row workers
+  struct RowBatch
+  {
+    int                                           numBlkRows;
+    CPelBuf                                       org;
+    CPelBuf                                       ref;
+    int                                           bitDepth;
+    const std::function<void( DistParam&, int )>* estimateRow;
+    std::atomic<int>                              nextRow;
+  };
+
+  void xRunRows            ( const int numBlkRows, const CPelBuf& org, const CPelBuf& ref, const int bitDepth, const std::function<void( DistParam&, int )>& estimateRow );
+  void xEstimateHierarchical( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int distScale, const int bitDepth, MotionField& field );
+  void xEstimateLevel      ( const MotionLevel& level, const MotionLevel* parent, const int bitDepth );
+  void xEstimateSeeded     ( const CPelBuf& org, const CPelBuf& ref, const bool refPadded, const int distScale, const int bitDepth, const MotionAnalysis& seed, MotionField& field );
+  /// diamond search starting at the best of the candidate MVs, at most maxIter large diamond steps
+  void xEstimateBlock      ( DistParam& distParam, const CPelBuf& org, const CPelBuf& ref, const int marginX, const int marginY, const int xOrg, const int yOrg, const int distScale, const int range,
+                             const Mv* cands, const int numCands, const int maxIter, Mv& mv, int& sad ) const;
+  void xEstimateRows       ( RowBatch& batch );
+  void xRowWorker          ( uint64_t batchId );
+  void xLookAheadWorker    ();
+
+  RdCost m_rdCost;
+  int    m_numThreads;
+  int    m_maxCUWidth;
+  int    m_maxCUHeight;
+  bool   m_hierarchical;
+
+  const MotionAnalysisCache* m_cache;
+
+  std::vector<std::thread> m_rowWorkers;      ///< m_numThreads - 1 workers, parked between batches
+  std::mutex               m_rowBatchMutex;   ///< one batch at a time, the encoder and the look-ahead may both estimate
+  std::mutex               m_rowMutex;
+  std::condition_variable  m_rowStart;        ///< new batch or stop request for the workers
+  std::condition_variable  m_rowDone;         ///< a worker has finished the current batch
+  RowBatch*                m_rowBatch;
+  uint64_t                 m_rowBatchId;
+  int                      m_rowPending;      ///< workers that have not yet finished the current batch
+  bool                     m_rowStop;
+
+  std::thread             m_lookAheadThread;
+  std::mutex              m_lookAheadMutex;
+  std::condition_variable m_lookAheadStart;   ///< new job or stop request for the worker
+  std::condition_variable m_lookAheadDone;    ///< a job has been finished
+  std::list<LookAheadJob> m_lookAheadJobs;    ///< in coding order
+  bool                    m_lookAheadStop;
+};
+
+//! \}
+
+#endif
@@ -1518,6 +1518,12 @@ void EncSlice::encodeCtus( Picture* pcPic, const bool bCompressEntireSlice, cons
     }
   }
 
+#if FEATURE_TEST
+  // the picture's time budget is shared by its slices in proportion to their CTUs
+  const bool   dtBudgetEnabled = ( pCfg->getDTMode() & DT_MODE_INFER ) && pCfg->getDTTimeBudget() > 0.0 && pcSlice->getSliceType() != I_SLICE;
+  DTTimeBudget dtTimeBudget( dtBudgetEnabled ? 1e-3 * pCfg->getDTTimeBudget() * pcSlice->getNumCtuInSlice() / pcv.sizeInCtus : 0.0, pcSlice->getNumCtuInSlice() );
+#endif
+
   // for every CTU in the slice
   for( uint32_t ctuIdx = 0; ctuIdx < pcSlice->getNumCtuInSlice(); ctuIdx++ )
   {
@@ -1682,6 +1688,12 @@ void EncSlice::encodeCtus( Picture* pcPic, const bool bCompressEntireSlice, cons
       pcPic->mctsInfo.init( &cs, ctuRsAddr );
     }
 
+#if FEATURE_TEST
+    if( dtTimeBudget.isActive() )
+    {
+      m_pcCuEncoder->getModeCtrl()->setDTThresholdOffset( dtTimeBudget.update( ctuIdx ) );
+    }
+#endif
   if (pCfg->getSwitchPOC() != pcPic->poc || ctuRsAddr >= pCfg->getDebugCTU())
     m_pcCuEncoder->compressCtu( cs, ctuArea, ctuRsAddr, prevQP, currQP );
 
@@ -1783,6 +1795,12 @@ void EncSlice::encodeCtus( Picture* pcPic, const bool bCompressEntireSlice, cons
       }
     }
   }
+#if FEATURE_TEST
+  if( dtTimeBudget.isActive() )
+  {
+    m_pcCuEncoder->getModeCtrl()->setDTThresholdOffset( 0.0f );
+  }
+#endif
 
   // this is wpp exclusive section
 
@@ -85,6 +85,9 @@ EncTemporalFilter::EncTemporalFilter() :
   m_QP(0),
   m_clipInputVideoToRec709Range(false),
   m_inputColourSpaceConvert(NUMBER_INPUT_COLOUR_SPACE_CONVERSIONS)
+#if FEATURE_TEST
+  , m_motionCache(nullptr)
+#endif
 {}
 
 void EncTemporalFilter::init(const int frameSkip,
@@ -174,8 +177,8 @@ bool EncTemporalFilter::filter(PelStorage *orgPic, int receivedPoc)
     PelStorage origSubsampled2;
     PelStorage origSubsampled4;
 
-    subsampleLuma(origPadded, origSubsampled2);
-    subsampleLuma(origSubsampled2, origSubsampled4);
+    subsampleLuma(origPadded.Y(), origSubsampled2, m_chromaFormatIDC, m_padding);
+    subsampleLuma(origSubsampled2.Y(), origSubsampled4, m_chromaFormatIDC, m_padding);
 
     // determine motion vectors
     for (int poc = firstFrame; poc <= lastFrame; poc++)
@@ -206,6 +209,26 @@ bool EncTemporalFilter::filter(PelStorage *orgPic, int receivedPoc)
 
       motionEstimation(srcPic.mvs, origPadded, srcPic.picBuffer, origSubsampled2, origSubsampled4);
       srcPic.origOffset = origOffset;
+#if FEATURE_TEST
+      if (m_motionCache != nullptr)
+      { // the 8x8 field against the original neighbour is reused as the start of the DT motion search
+        MotionAnalysis analysis;
+        analysis.blockSize   = 8;
+        analysis.mvPrecision = m_motionVectorFactor;
+        analysis.numBlkCols  = m_sourceWidth / analysis.blockSize;
+        analysis.numBlkRows  = m_sourceHeight / analysis.blockSize;
+        analysis.mvs.resize(analysis.numBlkCols * analysis.numBlkRows);
+        for (int blockY = 0; blockY < analysis.numBlkRows; blockY++)
+        {
+          for (int blockX = 0; blockX < analysis.numBlkCols; blockX++)
+          {
+            const MotionVector &mv = srcPic.mvs.get(blockX, blockY);
+            analysis.mvs[blockY * analysis.numBlkCols + blockX] = Mv(mv.x, mv.y);
+          }
+        }
+        m_motionCache->store(receivedPoc, receivedPoc + origOffset, std::move(analysis));
+      }
+#endif
       origOffset++;
     }
 
@@ -238,14 +261,14 @@ bool EncTemporalFilter::filter(PelStorage *orgPic, int receivedPoc)
 // Private member functions
 // ====================================================================================================================
 
-void EncTemporalFilter::subsampleLuma(const PelStorage &input, PelStorage &output, const int factor) const
+void EncTemporalFilter::subsampleLuma(const CPelBuf &input, PelStorage &output, const ChromaFormat chromaFormat, const int padding, const int factor)
 {
-  const int newWidth = input.Y().width / factor;
-  const int newHeight = input.Y().height / factor;
-  output.create(m_chromaFormatIDC, Area(0, 0, newWidth, newHeight), 0, m_padding);
+  const int newWidth = input.width / factor;
+  const int newHeight = input.height / factor;
+  output.create(chromaFormat, Area(0, 0, newWidth, newHeight), 0, padding);
 
-  const Pel* srcRow = input.Y().buf;
-  const int srcStride = input.Y().stride;
+  const Pel* srcRow = input.buf;
+  const int srcStride = input.stride;
   Pel *dstRow = output.Y().buf;
   const int dstStride = output.Y().stride;
 
@@ -262,7 +285,7 @@ void EncTemporalFilter::subsampleLuma(const PelStorage &input, PelStorage &outpu
       inRowBelow += 2;
     }
   }
-  output.extendBorderPel(m_padding, m_padding);
+  output.extendBorderPel(padding, padding);
 }
 
 int EncTemporalFilter::motionErrorLuma(const PelStorage &orig,
@@ -457,8 +480,8 @@ void EncTemporalFilter::motionEstimation(Array2D<MotionVector> &mv, const PelSto
   PelStorage bufferSub2;
   PelStorage bufferSub4;
 
-  subsampleLuma(buffer, bufferSub2);
-  subsampleLuma(bufferSub2, bufferSub4);
+  subsampleLuma(buffer.Y(), bufferSub2, m_chromaFormatIDC, m_padding);
+  subsampleLuma(bufferSub2.Y(), bufferSub4, m_chromaFormatIDC, m_padding);
 
   motionEstimationLuma(mv_0, origSubsampled4, bufferSub4, 16);
   motionEstimationLuma(mv_1, origSubsampled2, bufferSub2, 16, &mv_0, 2);
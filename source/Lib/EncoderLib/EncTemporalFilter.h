@@ -119,6 +119,11 @@ public:
     const bool gopBasedTemporalFilterFutureReference);
 
   bool filter(PelStorage *orgPic, int frame);
+#if FEATURE_TEST
+  void setMotionCache(MotionAnalysisCache *motionCache) { m_motionCache = motionCache; }
+#endif
+
+  static void subsampleLuma(const CPelBuf &input, PelStorage &output, const ChromaFormat chromaFormat, const int padding, const int factor = 2);
 
 private:
   // Private static member variables
@@ -147,9 +152,11 @@ private:
   InputColourSpaceConversion m_inputColourSpaceConvert;
   Area m_area;
   bool m_gopBasedTemporalFilterFutureReference;
+#if FEATURE_TEST
+  MotionAnalysisCache *m_motionCache;
+#endif
 
   // Private functions
-  void subsampleLuma(const PelStorage &input, PelStorage &output, const int factor = 2) const;
   int motionErrorLuma(const PelStorage &orig, const PelStorage &buffer, const int x, const int y, int dx, int dy, const int bs, const int besterror) const;
   void motionEstimationLuma(Array2D<MotionVector> &mvs, const PelStorage &orig, const PelStorage &buffer, const int bs,
     const Array2D<MotionVector> *previous=0, const int factor = 1, const bool doubleRes = false) const;
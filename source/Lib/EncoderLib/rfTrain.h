@@ -170,28 +170,28 @@ public:
 
 
 private:
-	double predictQTMTT_16_16(float features[], std::vector<int> indices);
-	double predictQTMTT_32_32(float features[], std::vector<int> indices);
-	double predictQTMTT_64_64(float features[], std::vector<int> indices);
-	double predictQTMTT_128_128(float features[], std::vector<int> indices);
+	double predictQTMTT_16_16(float features[], const std::vector<int>& indices);
+	double predictQTMTT_32_32(float features[], const std::vector<int>& indices);
+	double predictQTMTT_64_64(float features[], const std::vector<int>& indices);
+	double predictQTMTT_128_128(float features[], const std::vector<int>& indices);
 
-	double predictHorVer_8_8(float features[], std::vector<int> indices);
-	double predictHorVer_16_8(float features[], std::vector<int> indices);
-	double predictHorVer_8_16(float features[], std::vector<int> indices);
-	double predictHorVer_16_16(float features[], std::vector<int> indices);
-	double predictHorVer_32_8(float features[], std::vector<int> indices);
-	double predictHorVer_8_32(float features[], std::vector<int> indices);
-	double predictHorVer_32_16(float features[], std::vector<int> indices);
-	double predictHorVer_16_32(float features[], std::vector<int> indices);
-	double predictHorVer_32_32(float features[], std::vector<int> indices);
-	double predictHorVer_64_32(float features[], std::vector<int> indices);
-	double predictHorVer_32_64(float features[], std::vector<int> indices);
-	double predictHorVer_64_8(float features[], std::vector<int> indices);
-	double predictHorVer_8_64(float features[], std::vector<int> indices);
-	double predictHorVer_64_16(float features[], std::vector<int> indices);
-	double predictHorVer_16_64(float features[], std::vector<int> indices);
-	double predictHorVer_64_64(float features[], std::vector<int> indices);
-	double predictHorVer_128_128(float features[], std::vector<int> indices);
+	double predictHorVer_8_8(float features[], const std::vector<int>& indices);
+	double predictHorVer_16_8(float features[], const std::vector<int>& indices);
+	double predictHorVer_8_16(float features[], const std::vector<int>& indices);
+	double predictHorVer_16_16(float features[], const std::vector<int>& indices);
+	double predictHorVer_32_8(float features[], const std::vector<int>& indices);
+	double predictHorVer_8_32(float features[], const std::vector<int>& indices);
+	double predictHorVer_32_16(float features[], const std::vector<int>& indices);
+	double predictHorVer_16_32(float features[], const std::vector<int>& indices);
+	double predictHorVer_32_32(float features[], const std::vector<int>& indices);
+	double predictHorVer_64_32(float features[], const std::vector<int>& indices);
+	double predictHorVer_32_64(float features[], const std::vector<int>& indices);
+	double predictHorVer_64_8(float features[], const std::vector<int>& indices);
+	double predictHorVer_8_64(float features[], const std::vector<int>& indices);
+	double predictHorVer_64_16(float features[], const std::vector<int>& indices);
+	double predictHorVer_16_64(float features[], const std::vector<int>& indices);
+	double predictHorVer_64_64(float features[], const std::vector<int>& indices);
+	double predictHorVer_128_128(float features[], const std::vector<int>& indices);
 
 };
 